@@ -1,6 +1,7 @@
 #include "grafo.h"
 #include <iostream>
 #include <vector>
+#include <algorithm> // Para lower_bound y sort
 #include <cmath> // Usamos abs para calcular el error entre los valores de PageRank
 
 // Función para agregar una arista entre dos nodos
@@ -52,66 +53,147 @@ void agregarArista(Grafo& grafo, int origen, int destino) {
     }
     grafo.nodos[destino].gradoSalida++; // Aumentamos el grado de salida del nodo de destino
 }
+// Función para agregar muchas aristas de una vez
+void agregarAristasEnLote(Grafo& grafo, std::vector<std::pair<int, int>>& pares) {
+    // Como es no dirigido, cada par va en los dos sentidos
+    size_t cuantos = pares.size();
+    pares.reserve(2 * cuantos);
+    for (size_t k = 0; k < cuantos; ++k) {
+        pares.push_back({pares[k].second, pares[k].first});
+    }
+    // Ordenamos por origen y destino, así los repetidos quedan juntos
+    std::sort(pares.begin(), pares.end());
+
+    // Recorremos los pares de a un origen a la vez
+    size_t k = 0;
+    while (k < pares.size()) {
+        int origen = pares[k].first;
+        // Buscamos (o creamos) el nodo una sola vez para todas sus aristas
+        auto it = grafo.nodos.find(origen);
+        bool existia = it != grafo.nodos.end();
+        if (!existia) it = grafo.nodos.emplace_hint(grafo.nodos.end(), origen, NodoGrafo{0.0, 0, nullptr});
+        NodoGrafo& nodo = it->second;
+
+        while (k < pares.size() && pares[k].first == origen) {
+            // Contamos cuantas veces sale el mismo par, ese es el peso
+            int destino = pares[k].second;
+            int peso = 0;
+            while (k < pares.size() && pares[k].first == origen && pares[k].second == destino) {
+                peso++;
+                k++;
+            }
+
+            // Si el nodo ya tenía aristas puede que esta ya exista, en ese caso solo sumamos el peso
+            NodoAdyacente* actual = existia ? nodo.listaAdyacencia : nullptr;
+            while (actual && actual->idDestino != destino) actual = actual->siguiente;
+            if (actual) {
+                actual->peso += peso;
+            } else {
+                nodo.listaAdyacencia = new NodoAdyacente{destino, peso, nodo.listaAdyacencia};
+            }
+            nodo.gradoSalida += peso; // El grado de salida es la suma de los pesos
+        }
+    }
+    std::vector<std::pair<int, int>>().swap(pares);
+}
+
 // Calcula el PageRank de todos los nodos en el grafo
 // Se detiene cuando converge o cuando llega al máximo de iteraciones
+// Antes de iterar pasamos el grafo a arrays (los nodos en el orden del map, y para cada nodo
+// sus vecinos como posiciones con su peso/gradoSalida ya calculado), asi cada iteracion
+// recorre memoria seguida en O(nodos + aristas) sin buscar en el map ni crear uno nuevo
 int calcularPageRank(Grafo& grafo, int maxIter, double d, double tol) {
     int n = grafo.nodos.size(); // Número de nodos en el grafo
     if (n == 0) return 0; // Si no hay nodos, no tiene sentido calcular PageRank
 
-    // Inicializamos el PageRank de todos los nodos con un valor uniforme
+    // Los ids en el mismo orden que el map (ya vienen ordenados), la posicion es el indice del array
+    std::vector<int> ids;
+    std::vector<NodoGrafo*> nodos;
+    ids.reserve(n);
+    nodos.reserve(n);
     for (auto& par : grafo.nodos) {
-        par.second.pagerank = 1.0 / n; // Asignamos a cada nodo un valor inicial igual
+        ids.push_back(par.first);
+        nodos.push_back(&par.second);
     }
 
+    // Las aristas de cada nodo en arrays seguidos: destino (como posicion) y cuanto de su PR le pasa
+    std::vector<int> inicio(n + 1, 0);
+    std::vector<int> destino;
+    std::vector<double> fraccion;
+    std::vector<int> colgantes; // Los nodos sin salida (que no aportan a otros)
+    for (int i = 0; i < n; ++i) {
+        for (NodoAdyacente* vecino = nodos[i]->listaAdyacencia; vecino; vecino = vecino->siguiente) {
+            int pos = std::lower_bound(ids.begin(), ids.end(), vecino->idDestino) - ids.begin();
+            destino.push_back(pos);
+            fraccion.push_back(static_cast<double>(vecino->peso) / nodos[i]->gradoSalida);
+        }
+        inicio[i + 1] = destino.size();
+        if (nodos[i]->gradoSalida == 0) colgantes.push_back(i);
+    }
+
+    // Dos arrays que se van turnando (el PR actual y el nuevo), se piden una sola vez
+    // Inicializamos el PageRank de todos los nodos con un valor uniforme
+    std::vector<double> actual(n, 1.0 / n);
+    std::vector<double> nuevo(n);
+
     int iter;
+    bool convergio = false;
     for (iter = 0; iter < maxIter; ++iter) { // Recorremos hasta el máximo de iteraciones
-        std::map<int, double> nuevosPR; // Aquí almacenamos el nuevo PageRank para cada nodo
-        double sumaDangle = 0.0; // Variable para los nodos sin salida (que no aportan a otros)
-
-        // Primero, calculamos la contribución de los nodos colgantes
-        for (const auto& par : grafo.nodos) {
-            if (par.second.gradoSalida == 0) {
-                sumaDangle += par.second.pagerank; // Sumar el PageRank de los nodos sin salida
-            }
+        double sumaDangle = 0.0; // Variable para los nodos sin salida
+        for (int i : colgantes) {
+            sumaDangle += actual[i]; // Sumar el PageRank de los nodos sin salida
         }
 
-        // Ahora, calculamos el nuevo PageRank de cada nodo usando la fórmula
-        for (const auto& par : grafo.nodos) {
-            nuevosPR[par.first] = (1.0 - d) / n + d * sumaDangle / n; // Fórmula para calcular el PageRank
-        }
+        // La parte que le toca a todos, con la fórmula
+        double base = (1.0 - d) / n + d * sumaDangle / n;
+        for (int i = 0; i < n; ++i) nuevo[i] = base;
 
-        // Aquí es donde entran las conexiones: calculamos el PageRank basado en los vecinos
-        for (const auto& par : grafo.nodos) {
-            NodoAdyacente* vecino = par.second.listaAdyacencia; // Empezamos a recorrer la lista de adyacencia
-            while (vecino) {
-                nuevosPR[vecino->idDestino] += d * par.second.pagerank * (static_cast<double>(vecino->peso) / par.second.gradoSalida);
-                // Sumamos la contribución de cada vecino al PageRank del nodo de destino
-                vecino = vecino->siguiente; // Avanzamos al siguiente vecino
+        // Aquí es donde entran las conexiones: cada nodo reparte su PageRank entre sus vecinos
+        for (int i = 0; i < n; ++i) {
+            for (int k = inicio[i]; k < inicio[i + 1]; ++k) {
+                nuevo[destino[k]] += d * actual[i] * fraccion[k];
             }
         }
 
         double error = 0.0; // Variable para calcular el error total de la convergencia
-        for (const auto& par : grafo.nodos) {
-            error += std::abs(nuevosPR[par.first] - par.second.pagerank); // Sumamos las diferencias entre los PR actuales y los nuevos
+        for (int i = 0; i < n; ++i) {
+            error += std::abs(nuevo[i] - actual[i]); // Sumamos las diferencias entre los PR actuales y los nuevos
         }
 
-        // Actualizamos el PageRank de cada nodo con los nuevos valores
-        for (auto& par : grafo.nodos) {
-            par.second.pagerank = nuevosPR[par.first];
-        }
+        // El nuevo pasa a ser el actual, sin copiar
+        actual.swap(nuevo);
 
         // Si el error es menor que la tolerancia, consideramos que ya ha convergido
         if (error < tol) {
-            std::cout << "\nPageRank convergio en " << iter + 1 << " iteraciones.\n";
-            return iter + 1; // Devolvemos el número real de iteraciones realizadas
+            convergio = true;
+            break;
         }
     }
 
+    // Guardamos el PageRank final en cada nodo
+    for (int i = 0; i < n; ++i) {
+        nodos[i]->pagerank = actual[i];
+    }
+
+    if (convergio) {
+        std::cout << "\nPageRank convergio en " << iter + 1 << " iteraciones.\n";
+        return iter + 1; // Devolvemos el número real de iteraciones realizadas
+    }
+
     // Si llegamos al máximo de iteraciones sin converger, lo indicamos
     std::cout << "\nPageRank alcanzo el maximo de " << maxIter << " iteraciones.\n";
     return maxIter; // Retornamos el máximo de iteraciones si no hubo convergencia
 }
 
+// Recorremos el map una sola vez y dejamos cada PageRank en la posición de su id
+std::vector<double> armarTablaPageRank(const Grafo& grafo, int maxId) {
+    std::vector<double> tabla(maxId + 1, SIN_PAGERANK);
+    for (const auto& par : grafo.nodos) {
+        if (par.first >= 0 && par.first <= maxId) tabla[par.first] = par.second.pagerank;
+    }
+    return tabla;
+}
+
 // Función para mostrar las métricas del grafo
 void mostrarMétricas(const Grafo& grafo, int consultasUsadas, int iteraciones) {
     long long aristas = 0; // Variable para contar el número de aristas
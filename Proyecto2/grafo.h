@@ -3,6 +3,7 @@
 
 #include <map>  // Usamos map para almacenar los nodos y sus respectivas propiedades
 #include <vector> // Usamos vector si necesitamos listas dinámicas, en este caso para adyacencia
+#include <utility> // Para los pares de documentos
 
 // Representa una conexión a un nodo vecino
 // Aquí almacenamos el id del nodo destino, el peso de la conexión y el siguiente nodo en la lista de adyacencia
@@ -30,10 +31,24 @@ struct Grafo {
 // La función 'agregarArista' se usa para conectar dos nodos (documentos) con una arista
 void agregarArista(Grafo& grafo, int origen, int destino);
 
+// Agrega muchos pares de una vez (por ejemplo todos los del log de consultas)
+// Los pares se ordenan y los repetidos se juntan en una sola arista con peso antes de tocar el grafo,
+// así cada nodo se busca en el map una sola vez y no se recorren listas por cada par
+// Deja el vector de pares vacío
+void agregarAristasEnLote(Grafo& grafo, std::vector<std::pair<int, int>>& pares);
+
 // Calcula el PageRank de todos los nodos en el grafo
 // Se ejecuta hasta que el algoritmo converge o se alcanzan el máximo de iteraciones
 int calcularPageRank(Grafo& grafo, int maxIter, double d, double tol);
 
+// Valor que queda en la tabla para los documentos que nunca salieron en el log (no están en el grafo)
+const double SIN_PAGERANK = -1.0;
+
+// Arma una tabla densa con el PageRank de cada documento, donde la posición es el id (de 0 a maxId)
+// Se arma una sola vez después de calcularPageRank, así buscar el PageRank de un resultado
+// es leer una posición del vector en vez de buscar el nodo en el map
+std::vector<double> armarTablaPageRank(const Grafo& grafo, int maxId);
+
 // Muestra las métricas del grafo: número de nodos, aristas, iteraciones, etc.
 void mostrarMétricas(const Grafo& grafo, int consultasUsadas, int iteraciones);
 
@@ -12,6 +12,36 @@
 #include "utils.h"
 #include "grafo.h"
 
+// Intersecta las listas de documentos de los términos de una consulta (consulta AND)
+// Cada lista enlazada se copia una sola vez a un vector ordenado, y después se intersectan
+// de la más corta a la más larga con una mezcla lineal, en vez de recorrer todas las listas
+// por cada documento de la primera. El resultado queda ordenado por DocID.
+std::vector<int> intersectarListas(const std::vector<NodoDoc*>& listas) {
+    std::vector<std::vector<int>> ordenadas; // Las listas pasadas a vectores ordenados
+    for (NodoDoc* lista : listas) {
+        std::vector<int> ids;
+        for (NodoDoc* doc = lista; doc; doc = doc->siguiente) ids.push_back(doc->idDocumento);
+        std::sort(ids.begin(), ids.end()); // Las listas se insertan al principio, así que vienen al revés
+        ordenadas.push_back(std::move(ids));
+    }
+    if (ordenadas.empty()) return {};
+
+    // Ordenamos por cantidad de documentos, así el resultado parcial nunca crece
+    std::sort(ordenadas.begin(), ordenadas.end(), [](const std::vector<int>& a, const std::vector<int>& b) {
+        return a.size() < b.size();
+    });
+
+    std::vector<int> resultado = ordenadas[0];
+    std::vector<int> aux;
+    for (size_t j = 1; j < ordenadas.size() && !resultado.empty(); ++j) {
+        aux.clear();
+        std::set_intersection(resultado.begin(), resultado.end(),
+                              ordenadas[j].begin(), ordenadas[j].end(), std::back_inserter(aux));
+        resultado.swap(aux); // Nos quedamos solo con los documentos comunes
+    }
+    return resultado;
+}
+
 int main(int argc, char* argv[]) {
     // Verificamos que se hayan pasado los 3 archivos necesarios como argumentos
     if (argc != 4) {
@@ -37,11 +67,13 @@ int main(int argc, char* argv[]) {
     std::string linea;
     int idDoc = 1; // Iniciamos el ID del documento
 
-    // Primero contamos cuántos documentos hay en total para mostrar el progreso
-    int totalDocs = 0;
-    std::ifstream contar(archivoDocumentos); // Abrimos el archivo nuevamente para contar las líneas
-    while (std::getline(contar, linea)) totalDocs++; // Contamos cuántas líneas hay
-    contar.close(); // Cerramos el archivo
+    // Para mostrar el progreso usamos el tamaño del archivo en bytes, así no hay que leerlo
+    // dos veces (una para contar las líneas y otra para indexar)
+    documentos.seekg(0, std::ios::end);
+    long long totalBytes = static_cast<long long>(documentos.tellg());
+    documentos.seekg(0, std::ios::beg);
+    long long bytesLeidos = 0;
+    int ultimoProgreso = -1;
 
     // Mostramos un mensaje de inicio para la construcción del índice
     std::cout << "Construyendo índice invertido...\n";
@@ -61,9 +93,13 @@ int main(int argc, char* argv[]) {
             }
         }
 
-        // Calculamos el progreso de la construcción del índice y lo mostramos
-        int progreso = (idDoc * 100) / totalDocs;
-        std::cout << "\rProgreso índice: " << progreso << "%" << std::flush;
+        // Calculamos el progreso de la construcción del índice y lo mostramos (solo si cambió)
+        bytesLeidos += static_cast<long long>(linea.size()) + 1;
+        int progreso = totalBytes > 0 ? static_cast<int>(std::min(100LL, bytesLeidos * 100 / totalBytes)) : 100;
+        if (progreso != ultimoProgreso) {
+            std::cout << "\rProgreso índice: " << progreso << "%" << std::flush;
+            ultimoProgreso = progreso;
+        }
         idDoc++; // Incrementamos el ID del documento
     }
     documentos.close(); // Cerramos el archivo de documentos
@@ -82,6 +118,7 @@ int main(int argc, char* argv[]) {
     auto startGrafo = std::chrono::steady_clock::now(); // Iniciamos la medición del tiempo para la construcción del grafo
 
     std::cout << "Construyendo grafo de co-relevancia...\n";
+    std::vector<std::pair<int, int>> pares; // Todos los pares de documentos, el grafo se arma al final de una vez
     for (size_t i = 0; i < todasConsultas.size(); ++i) { // Recorremos todas las consultas
         std::string consulta = todasConsultas[i]; // Tomamos la consulta actual
         std::istringstream iss(consulta); // Creamos un flujo de entrada con la consulta
@@ -96,40 +133,17 @@ int main(int argc, char* argv[]) {
             }
         }
 
-        std::set<int> resultado; // Aquí guardamos los documentos que son relevantes para la consulta
-        if (!listas.empty() && listas[0] != nullptr) { // Si la lista no está vacía
-            NodoDoc* base = listas[0]; // Empezamos a comparar los documentos
-            while (base) { // Comprobamos si el documento está en todos los conjuntos
-                bool comun = true;
-                for (size_t j = 1; j < listas.size(); ++j) { // Recorremos los demás documentos
-                    NodoDoc* aux = listas[j];
-                    bool encontrado = false;
-                    while (aux) { // Buscamos si el documento está presente
-                        if (aux->idDocumento == base->idDocumento) { // Si lo encontramos
-                            encontrado = true;
-                            break;
-                        }
-                        aux = aux->siguiente; // Avanzamos al siguiente documento
-                    }
-                    if (!encontrado) { // Si no está en alguno, lo marcamos como no común
-                        comun = false;
-                        break;
-                    }
-                }
-                if (comun) resultado.insert(base->idDocumento); // Si el documento está en todos, lo agregamos
-                base = base->siguiente; // Pasamos al siguiente documento
-            }
-        }
+        std::vector<int> resultado = intersectarListas(listas); // Documentos relevantes para la consulta, ordenados por DocID
 
         if (!resultado.empty()) { // Si encontramos documentos relevantes
             consultasUsadas++; // Aumentamos el contador de consultas usadas
-            std::vector<int> topDocs(resultado.begin(), resultado.end()); // Convertimos el set a un vector
+            std::vector<int> topDocs(resultado); // Copiamos los resultados para quedarnos con los primeros
             if (topDocs.size() > 10) topDocs.resize(10); // Limitamos a los 10 primeros documentos
 
-            // Añadimos las aristas entre los documentos relevantes en el grafo
+            // Anotamos las aristas entre los documentos relevantes
             for (size_t j = 0; j < topDocs.size(); ++j) {
                 for (size_t k = j + 1; k < topDocs.size(); ++k) {
-                    agregarArista(grafo, topDocs[j], topDocs[k]);
+                    pares.push_back({topDocs[j], topDocs[k]});
                 }
             }
         }
@@ -139,6 +153,7 @@ int main(int argc, char* argv[]) {
         std::cout << "\rProgreso grafo: " << progreso << "%" << std::flush;
     }
 
+    agregarAristasEnLote(grafo, pares); // Armamos el grafo con todos los pares juntos
     auto endGrafo = std::chrono::steady_clock::now(); // Medimos el tiempo final para el grafo
     std::cout << "\nGrafo de co-relevancia construido.\n";
 
@@ -153,6 +168,9 @@ int main(int argc, char* argv[]) {
 
     mostrarMétricas(grafo, consultasUsadas, iteracionesReales); // Mostramos las métricas del grafo
 
+    // Dejamos el PageRank de cada documento en una tabla por id (los ids van de 1 a idDoc - 1)
+    std::vector<double> pageRankPorDoc = armarTablaPageRank(grafo, idDoc - 1);
+
     // Calculamos los tiempos totales
     auto durGrafo = std::chrono::duration<double>(endGrafo - startGrafo).count();
     auto durPR = std::chrono::duration<double>(endPR - startPR).count();
@@ -183,41 +201,8 @@ int main(int argc, char* argv[]) {
             }
         }
 
-     std::set<int> resultado; // Usamos un set para almacenar los documentos que coinciden con todos los términos de la consulta
-if (!listas.empty() && listas[0] != nullptr) {  // Si la lista de documentos no está vacía y no es nula
-    NodoDoc* base = listas[0]; // Tomamos el primer conjunto de documentos (de la primera palabra de la consulta)
-    
-    while (base) {  // Recorremos la lista de documentos del primer término
-        bool comun = true; // Inicializamos una bandera que verificará si este documento está en todos los conjuntos
-
-        for (size_t j = 1; j < listas.size(); ++j) { // Iteramos sobre los otros conjuntos de documentos correspondientes a los demás términos
-            NodoDoc* aux = listas[j];  // Empezamos con la lista de documentos de otro término
-            bool encontrado = false;  // Inicializamos una bandera para saber si encontramos el documento en esta lista
-
-            while (aux) {  // Recorremos la lista de documentos del término actual
-                if (aux->idDocumento == base->idDocumento) {  // Si encontramos el mismo documento que en la primera lista
-                    encontrado = true;  // Marcamos que encontramos el documento
-                    break;  // Terminamos la búsqueda en esta lista, ya que lo encontramos
-                }
-                aux = aux->siguiente;  // Avanzamos al siguiente documento
-            }
-
-            if (!encontrado) {  // Si no encontramos el documento en alguna lista, significa que no es común a todos los términos
-                comun = false;  // Marcamos que este documento no es común y salimos del bucle
-                break;  // No seguimos buscando más, ya que este documento no es relevante para la consulta
-            }
-        }
-
-        if (comun) {  // Si el documento está en todas las listas (es decir, es relevante para todos los términos)
-            resultado.insert(base->idDocumento);  // Lo agregamos al conjunto de resultados
-        }
-
-        base = base->siguiente;  // Pasamos al siguiente documento de la lista de la primera palabra
-    }
-}
-
-            }
-        }
+        // Documentos que coinciden con todos los términos de la consulta
+        std::vector<int> resultado = intersectarListas(listas);
 
         if (!resultado.empty()) { // Si encontramos resultados
             std::cout << "Resultados sin PageRank (por DocID): ";
@@ -226,7 +211,9 @@ if (!listas.empty() && listas[0] != nullptr) {  // Si la lista de documentos no
 
             std::vector<std::pair<int, double>> ranking;
             for (int id : resultado) {
-                double pr = grafo.nodos.count(id) ? grafo.nodos.at(id).pagerank : 0.0;
+                // Si el documento no está en el grafo su PageRank es 0
+                double pr = (id < static_cast<int>(pageRankPorDoc.size()) && pageRankPorDoc[id] != SIN_PAGERANK)
+                            ? pageRankPorDoc[id] : 0.0;
                 ranking.push_back({id, pr}); // Creamos el ranking con los PageRank
             }
             std::sort(ranking.begin(), ranking.end(), [](auto& a, auto& b) {
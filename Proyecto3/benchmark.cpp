@@ -0,0 +1,524 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <iomanip>
+#include <algorithm>
+#include <map>
+#include <thread>
+#include <random>
+#include <cmath>
+#include <cstdlib>
+
+#include "index.h"
+#include "utils.h"
+#include "interseccion.h"
+#include "grafo.h"
+#include "cache.h"
+#include "segmento.h"
+#include "ranking.h"
+
+using namespace std;
+using namespace std::chrono;
+
+// programa aparte para medir las partes del buscador sin el bucle interactivo
+// uso: ./benchmark <prueba> <documentos.dat> <consultas.dat> <stopwords.txt>
+//      (prueba: interseccion, construccion o bm25)
+//      ./benchmark pagerank [maxNodos]   (grafos sinteticos, no lee archivos)
+//      ./benchmark cache                 (cache concurrente con claves sinteticas)
+//      ./benchmark politicas <consultas.dat> [capacidad...]  (hits de LRU vs TinyLFU con el log)
+
+// para leer todas las consultas del log
+vector<string> leerConsultas(const string& archivo) {
+    ifstream consultas(archivo);
+    vector<string> todas;
+    string linea;
+    while (getline(consultas, linea)) {
+        if (!linea.empty()) todas.push_back(linea);
+    }
+    return todas;
+}
+
+// la interseccion original: para cada doc de la primera lista recorre todas las otras enteras
+// (trabaja sobre las listas ya descomprimidas)
+void interseccionLineal(const vector<const vector<int>*>& listas, vector<int>& resultado) {
+    resultado.clear();
+    if (listas.empty()) return;
+    for (int id : *listas[0]) {
+        bool comun = true;
+        for (size_t j = 1; j < listas.size() && comun; ++j) {
+            comun = find(listas[j]->begin(), listas[j]->end(), id) != listas[j]->end();
+        }
+        if (comun) resultado.push_back(id);
+    }
+}
+
+// la del bucle con busqueda binaria por cada candidato de la primera lista
+void interseccionBinaria(const vector<const vector<int>*>& listas, vector<int>& resultado) {
+    resultado.clear();
+    if (listas.empty()) return;
+    for (int id : *listas[0]) {
+        bool comun = true;
+        for (size_t j = 1; j < listas.size() && comun; ++j) {
+            comun = binary_search(listas[j]->begin(), listas[j]->end(), id);
+        }
+        if (comun) resultado.push_back(id);
+    }
+}
+
+// compara los tres metodos de interseccion sobre todas las consultas del log
+int benchmarkInterseccion(IndiceInvertido& indice, const vector<string>& consultas,
+                          const FiltroStopwords& stopwords) {
+    // primero resolvemos las listas de cada consulta, asi solo medimos la interseccion
+    vector<vector<ListaPostings>> listasPorConsulta(consultas.size());
+    for (size_t i = 0; i < consultas.size(); ++i)
+        obtenerListasConsulta(indice, consultas[i], stopwords, listasPorConsulta[i]);
+
+    // los metodos viejos usan las listas descomprimidas (una copia por termino)
+    map<const unsigned char*, vector<int>> descomprimidas; // por termino (sus datos son unicos)
+    vector<vector<const vector<int>*>> planasPorConsulta(consultas.size());
+    for (size_t i = 0; i < consultas.size(); ++i) {
+        for (const ListaPostings& lista : listasPorConsulta[i]) {
+            auto it = descomprimidas.find(lista.datos);
+            if (it == descomprimidas.end()) {
+                it = descomprimidas.emplace(lista.datos, vector<int>()).first;
+                descomprimirLista(lista, it->second, nullptr);
+            }
+            planasPorConsulta[i].push_back(&it->second);
+        }
+    }
+
+    const int repeticiones = 5;
+    vector<int> resultado, esperado;
+    long long totalResultados = 0;
+    double tiempos[3] = {0.0, 0.0, 0.0};
+    const char* nombres[3] = {"lineal (original)", "busqueda binaria", "comprimida por bloques"};
+
+    for (int metodo = 0; metodo < 3; ++metodo) {
+        // la lineal es cuadratica, con una pasada alcanza
+        int veces = (metodo == 0) ? 1 : repeticiones;
+        high_resolution_clock::time_point inicio = high_resolution_clock::now();
+        for (int r = 0; r < veces; ++r) {
+            for (size_t i = 0; i < listasPorConsulta.size(); ++i) {
+                if (metodo == 0) interseccionLineal(planasPorConsulta[i], resultado);
+                else if (metodo == 1) interseccionBinaria(planasPorConsulta[i], resultado);
+                else intersectarListas(listasPorConsulta[i], resultado);
+                if (r == 0 && metodo == 0) totalResultados += resultado.size();
+            }
+        }
+        tiempos[metodo] = duration<double>(high_resolution_clock::now() - inicio).count() / veces;
+    }
+
+    // revisamos que los tres den lo mismo
+    for (size_t i = 0; i < listasPorConsulta.size(); ++i) {
+        interseccionBinaria(planasPorConsulta[i], esperado);
+        interseccionLineal(planasPorConsulta[i], resultado);
+        if (resultado != esperado) { cerr << "❌ Error: la interseccion lineal no coincide.\n"; return 1; }
+        intersectarListas(listasPorConsulta[i], resultado);
+        if (resultado != esperado) { cerr << "❌ Error: la interseccion galloping/SIMD no coincide.\n"; return 1; }
+    }
+
+    cout << "\n--- Benchmark de interseccion ---\n";
+    cout << "Consultas: " << consultas.size() << "\n";
+    cout << "Resultados totales: " << totalResultados << "\n";
+    for (int metodo = 0; metodo < 3; ++metodo) {
+        cout << setw(20) << left << nombres[metodo] << ": " << fixed << setprecision(6) << tiempos[metodo]
+             << " s  (" << setprecision(2) << tiempos[0] / tiempos[metodo] << "x)\n";
+    }
+
+    // el log en orden con la cache de pares de terminos (vacia al empezar cada pasada)
+    CacheIntersecciones pares;
+    double tiempoPares = 0.0;
+    for (int r = 0; r < repeticiones; ++r) {
+        if (r > 0) liberarCacheIntersecciones(pares);
+        inicializarCacheIntersecciones(pares, 4 << 20);
+        high_resolution_clock::time_point inicio = high_resolution_clock::now();
+        for (size_t i = 0; i < listasPorConsulta.size(); ++i) intersectarListas(listasPorConsulta[i], resultado, pares);
+        tiempoPares += duration<double>(high_resolution_clock::now() - inicio).count();
+    }
+    tiempoPares /= repeticiones;
+    // los contadores de la ultima pasada, antes de que la revision los siga sumando
+    long long consultasPares = pares.consultas, aciertosPares = pares.aciertos;
+    long long ahorrados = pares.postingsAhorrados, totales = pares.postingsTotales;
+    // una pasada mas para revisar (con la cache ya llena)
+    for (size_t i = 0; i < listasPorConsulta.size(); ++i) {
+        interseccionBinaria(planasPorConsulta[i], esperado);
+        intersectarListas(listasPorConsulta[i], resultado, pares);
+        if (resultado != esperado) { cerr << "❌ Error: la interseccion con cache de pares no coincide.\n"; return 1; }
+    }
+    cout << setw(20) << left << "con cache de pares" << ": " << fixed << setprecision(6) << tiempoPares
+         << " s  (" << setprecision(2) << tiempos[0] / tiempoPares << "x)\n" << right;
+    cout << "Cache de pares (una pasada): " << aciertosPares << " aciertos en " << consultasPares
+         << " consultas de 2+ terminos, " << ahorrados << " de " << totales
+         << " postings sin recorrer\n";
+    liberarCacheIntersecciones(pares);
+    return 0;
+}
+
+// consultas OR con BM25 + pagerank: block-max WAND contra puntuar todos los docs de las listas.
+// el pagerank es al azar (no hace falta el grafo para medir la poda), y tienen que dar lo mismo.
+// como en el grafo de verdad, solo unos pocos docs tienen pagerank (los que salieron en resultados)
+int benchmarkBM25(IndiceInvertido& indice, const vector<string>& consultas, const FiltroStopwords& stopwords) {
+    mt19937 generador(7);
+    uniform_real_distribution<double> azar(0.0, 1.0);
+    vector<double> pageRankPorDoc(indice.numDocs + 1, 0.0);
+    double suma = 0.0;
+    for (double& pr : pageRankPorDoc)
+        if (azar(generador) < 0.05) suma += (pr = pow(azar(generador), 4.0));
+    for (double& pr : pageRankPorDoc) pr /= suma;
+    TablaPageRank tablaPageRank;
+    armarTablaPageRank(pageRankPorDoc, 64, tablaPageRank);
+    Segmento segmento;
+    FirmasSegmento firmas = {};
+    construirSegmento(indice, tablaPageRank, firmas, segmento);
+    liberarTablaPageRank(tablaPageRank);
+
+    vector<vector<ListaPostings>> listasPorConsulta(consultas.size());
+    for (size_t i = 0; i < consultas.size(); ++i)
+        obtenerListasConsulta(segmento, consultas[i], stopwords, listasPorConsulta[i]);
+
+    cout << "\n--- Benchmark BM25 + PageRank (consultas OR) ---\n";
+    cout << "    k   exhaustivo (s)  docs puntuados   WAND (s)  docs puntuados  aceleracion\n";
+    vector<DocPuntaje> esperado, obtenido;
+    const int repeticiones = 5;
+    for (size_t k : {10, 100, 1000}) {
+        long long puntuadosExhaustivo = 0, puntuadosWAND = 0;
+        double tiempos[2] = {0.0, 0.0};
+        for (int metodo = 0; metodo < 2; ++metodo) {
+            high_resolution_clock::time_point inicio = high_resolution_clock::now();
+            for (int r = 0; r < repeticiones; ++r) {
+                for (const vector<ListaPostings>& listas : listasPorConsulta) {
+                    long long puntuados = metodo == 0 ? topKBM25Exhaustivo(segmento, listas, k, obtenido)
+                                                      : topKBM25(segmento, listas, k, obtenido);
+                    if (r == 0) (metodo == 0 ? puntuadosExhaustivo : puntuadosWAND) += puntuados;
+                }
+            }
+            tiempos[metodo] = duration<double>(high_resolution_clock::now() - inicio).count() / repeticiones;
+        }
+        // revisamos que den los mismos docs con los mismos puntajes
+        for (const vector<ListaPostings>& listas : listasPorConsulta) {
+            topKBM25Exhaustivo(segmento, listas, k, esperado);
+            topKBM25(segmento, listas, k, obtenido);
+            if (obtenido != esperado) { cerr << "❌ Error: WAND no coincide con el exhaustivo.\n"; return 1; }
+        }
+        cout << setw(5) << k << fixed << setprecision(6) << setw(17) << tiempos[0] << setw(16) << puntuadosExhaustivo
+             << setw(11) << tiempos[1] << setw(16) << puntuadosWAND << setprecision(2) << setw(12)
+             << tiempos[0] / tiempos[1] << "x\n";
+    }
+    cerrarSegmento(segmento);
+    return 0;
+}
+
+// compara dos indices termino por termino (ids y frecuencias)
+bool indicesIguales(IndiceInvertido& a, IndiceInvertido& b) {
+    if (a.numTerminos != b.numTerminos || a.numDocs != b.numDocs) return false;
+    if (a.largoDocumentos != b.largoDocumentos) return false;
+    vector<int> idsA, frecA, idsB, frecB;
+    for (NodoTermino* t = a.inicio; t != nullptr; t = t->siguiente) {
+        NodoTermino* otro = buscarTermino(b, t->termino);
+        if (!otro) return false;
+        descomprimirLista(t->listaDocumentos, idsA, &frecA);
+        descomprimirLista(otro->listaDocumentos, idsB, &frecB);
+        if (idsA != idsB || frecA != frecB) return false;
+    }
+    return true;
+}
+
+// construye el indice con 1, 2, 4... hilos (hasta los nucleos de la maquina) y mide la aceleracion
+int benchmarkConstruccion(IndiceInvertido& secuencial, const string& archivoDocumentos,
+                          const FiltroStopwords& stopwords, double tiempoSecuencial) {
+    int nucleos = max(1u, thread::hardware_concurrency());
+    cout << "\n--- Benchmark de construccion paralela (" << nucleos << " nucleos) ---\n";
+    cout << "hilos  segundos  aceleracion\n";
+    cout << setw(5) << 1 << "  " << fixed << setprecision(3) << tiempoSecuencial << "  1.00x\n";
+    for (int hilos = 2; hilos <= max(2, nucleos); hilos *= 2) {
+        IndiceInvertido paralelo;
+        inicializarIndice(paralelo);
+        high_resolution_clock::time_point inicio = high_resolution_clock::now();
+        if (construirIndiceParalelo(paralelo, archivoDocumentos, stopwords, hilos) < 0) {
+            liberarIndice(paralelo);
+            return 1;
+        }
+        double tiempo = duration<double>(high_resolution_clock::now() - inicio).count();
+        bool iguales = indicesIguales(secuencial, paralelo);
+        liberarIndice(paralelo);
+        cout << setw(5) << hilos << "  " << setprecision(3) << tiempo << "  " << setprecision(2)
+             << tiempoSecuencial / tiempo << "x\n";
+        if (!iguales) { cerr << "❌ Error: el indice con " << hilos << " hilos no es igual al secuencial.\n"; return 1; }
+    }
+    return 0;
+}
+
+// arma un grafo sintetico parecido al de co-relevancia: cada nodo se conecta con
+// aristasPorNodo nodos, casi siempre con los de ids bajos (unos pocos nodos muy conectados)
+// enLote elige entre agregarArista por cada par o juntar los pares y usar agregarLote
+void grafoSintetico(Grafo& grafo, int numNodos, int aristasPorNodo, bool enLote) {
+    mt19937 generador(12345);
+    uniform_real_distribution<double> azar(0.0, 1.0);
+    inicializarGrafo(grafo);
+    vector<unsigned long long> pares;
+    for (int i = 0; i < numNodos; ++i) {
+        for (int k = 0; k < aristasPorNodo; ++k) {
+            int destino = static_cast<int>(numNodos * pow(azar(generador), 3.0));
+            if (destino == i) continue;
+            if (enLote) pares.push_back(claveArista(i + 1, destino + 1));
+            else agregarArista(grafo, i + 1, destino + 1);
+        }
+    }
+    if (enLote) agregarLote(grafo, pares);
+    else congelarGrafo(grafo);
+}
+
+// las aristas de un grafo como (id, id vecino, peso) ordenadas, para comparar grafos
+// aunque sus nodos esten numerados distinto
+vector<pair<pair<int, int>, int>> aristasPorId(const Grafo& grafo) {
+    vector<pair<pair<int, int>, int>> aristas;
+    for (int i = 0; i < grafo.numNodos; ++i)
+        for (int k = grafo.inicioVecinos[i]; k < grafo.inicioVecinos[i + 1]; ++k)
+            aristas.push_back({{grafo.ids[i], grafo.ids[grafo.vecinos[k]]}, grafo.pesos[k]});
+    sort(aristas.begin(), aristas.end());
+    return aristas;
+}
+
+// agrega lotes de aristas nuevas (algunas con nodos nuevos) de distintos tamaños y compara
+// actualizarPageRank contra calcular todo de cero. los dos parten de un pagerank convergido.
+// meter el lote en el CSR (congelarGrafo) cuesta lo mismo para los dos, asi que se mide aparte
+int benchmarkIncremental(Grafo& grafo) {
+    const int maxIter = 200;
+    const int lotes[] = {10, 100, 1000};
+    calcularPageRank(grafo, maxIter, 0.85);
+
+    mt19937 generador(54321);
+    for (int lote : lotes) {
+        int numNodos = grafo.numNodos;
+        uniform_int_distribution<int> nodo(1, numNodos + max(1, lote / 10)); // ~1 de cada 10 extremos es un nodo nuevo
+        for (int k = 0; k < lote; ++k) {
+            int a = nodo(generador), b = nodo(generador);
+            if (a != b) agregarArista(grafo, a, b);
+        }
+
+        high_resolution_clock::time_point inicio = high_resolution_clock::now();
+        congelarGrafo(grafo);
+        double tiempoCongelar = duration<double>(high_resolution_clock::now() - inicio).count();
+
+        inicio = high_resolution_clock::now();
+        int iteracionesIncremental = actualizarPageRank(grafo, maxIter, 0.85);
+        double tiempoIncremental = duration<double>(high_resolution_clock::now() - inicio).count();
+        vector<double> incremental = grafo.pageRank;
+
+        inicio = high_resolution_clock::now();
+        int iteraciones = calcularPageRank(grafo, maxIter, 0.85);
+        double tiempoCompleto = duration<double>(high_resolution_clock::now() - inicio).count();
+        double diferencia = 0.0;
+        for (int i = 0; i < grafo.numNodos; ++i) diferencia += fabs(grafo.pageRank[i] - incremental[i]);
+
+        cout << "Lote de " << lote << " aristas (CSR en " << setprecision(3) << tiempoCongelar * 1000
+             << " ms): incremental " << tiempoIncremental * 1000 << " ms (";
+        if (iteracionesIncremental == 0) cout << "solo empujando";
+        else cout << iteracionesIncremental << " iteraciones despues de empujar";
+        cout << "), completo " << tiempoCompleto * 1000 << " ms (" << iteraciones << " iteraciones), diferencia "
+             << scientific << setprecision(1) << diferencia << fixed << "\n";
+        // el completo para con un error de ~1e-6 y al incremental le puede faltar hasta 1e-5 / (1 - d)
+        if (diferencia > 1e-4) {
+            cerr << "❌ Error: el pagerank incremental se aleja del completo.\n";
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// pagerank con 1, 2, 4... hilos sobre grafos de 10^5 nodos hasta maxNodos
+// (10^7 nodos necesita varios GB para armar el grafo, por eso no es el maximo por defecto)
+int benchmarkPageRank(int maxNodos) {
+    const int iteraciones = 20;
+    int nucleos = max(1u, thread::hardware_concurrency());
+    cout << "--- Benchmark de PageRank paralelo (" << nucleos << " nucleos, " << iteraciones << " iteraciones) ---\n";
+    for (int numNodos = 100000; numNodos <= maxNodos; numNodos *= 10) {
+        // armamos el grafo par por par y en lote, tienen que dar lo mismo
+        Grafo grafo;
+        high_resolution_clock::time_point inicio = high_resolution_clock::now();
+        grafoSintetico(grafo, numNodos, 5, false);
+        double tiempoPorPar = duration<double>(high_resolution_clock::now() - inicio).count();
+        vector<pair<pair<int, int>, int>> porPar = aristasPorId(grafo);
+        liberarGrafo(grafo);
+        inicio = high_resolution_clock::now();
+        grafoSintetico(grafo, numNodos, 5, true);
+        double tiempoLote = duration<double>(high_resolution_clock::now() - inicio).count();
+        cout << "\nNodos: " << grafo.numNodos << ", aristas: " << grafo.numAristas << " (armado en "
+             << fixed << setprecision(3) << tiempoPorPar << " s par por par, " << tiempoLote << " s en lote)\n";
+        if (aristasPorId(grafo) != porPar) {
+            cerr << "❌ Error: el grafo armado en lote no es igual al armado par por par.\n";
+            liberarGrafo(grafo);
+            return 1;
+        }
+        cout << "hilos  segundos  ms/iter  aceleracion  diferencia\n";
+
+        // con tantos nodos no converge antes de las 20 iteraciones, asi que todas las corridas hacen las mismas
+        inicio = high_resolution_clock::now();
+        calcularPageRank(grafo, iteraciones, 0.85);
+        double tiempoSecuencial = duration<double>(high_resolution_clock::now() - inicio).count();
+        vector<double> secuencial = grafo.pageRank;
+        cout << setw(5) << 1 << "  " << setprecision(3) << tiempoSecuencial << "  " << setw(7)
+             << tiempoSecuencial * 1000 / iteraciones << "  " << setw(10) << "1.00" << "x\n";
+
+        for (int hilos = 2; hilos <= max(4, nucleos); hilos *= 2) {
+            inicio = high_resolution_clock::now();
+            calcularPageRankParalelo(grafo, iteraciones, 0.85, hilos);
+            double tiempo = duration<double>(high_resolution_clock::now() - inicio).count();
+            // tiene que dar lo mismo salvo el redondeo por sumar en otro orden
+            double diferencia = 0.0;
+            for (int i = 0; i < grafo.numNodos; ++i)
+                diferencia = max(diferencia, fabs(grafo.pageRank[i] - secuencial[i]));
+            cout << setw(5) << hilos << "  " << setprecision(3) << tiempo << "  " << setw(7)
+                 << tiempo * 1000 / iteraciones << "  " << setprecision(2) << setw(10)
+                 << tiempoSecuencial / tiempo << "x  " << scientific << setprecision(1) << diferencia
+                 << fixed << "\n";
+            if (diferencia > 1e-9) {
+                cerr << "❌ Error: el pagerank con " << hilos << " hilos no coincide con el secuencial.\n";
+                liberarGrafo(grafo);
+                return 1;
+            }
+        }
+        if (benchmarkIncremental(grafo) != 0) { liberarGrafo(grafo); return 1; }
+        liberarGrafo(grafo);
+    }
+    return 0;
+}
+
+// varios hilos usando la misma cache: cada uno busca claves (unas pocas muy repetidas, como en un log)
+// y si no estan las inserta. se compara una cache de 1 fragmento (un solo candado para todos)
+// contra una partida en fragmentos
+int benchmarkCache() {
+    const int operaciones = 200000;     // por hilo
+    const int claves = 20000;
+    const int capacidad = 4096;
+    int nucleos = max(1u, thread::hardware_concurrency());
+    cout << "--- Benchmark de cache concurrente (" << nucleos << " nucleos, " << operaciones
+         << " operaciones por hilo, capacidad " << capacidad << ") ---\n";
+    cout << "fragmentos  hilos  Mops/s  hits\n";
+
+    vector<string> textos(claves);
+    for (int k = 0; k < claves; ++k) textos[k] = "consulta " + to_string(k);
+    vector<int> resultados(10, 1);
+
+    for (int numFragmentos : {1, 16}) {
+        for (int hilos = 1; hilos <= max(8, nucleos); hilos *= 2) {
+            CacheConcurrente cache;
+            inicializarCacheConcurrente(cache, capacidad, numFragmentos, 53);
+            vector<long long> hits(hilos, 0);
+            auto trabajar = [&](int h) {
+                mt19937 generador(h + 1);
+                uniform_real_distribution<double> azar(0.0, 1.0);
+                vector<int> encontrados;
+                for (int k = 0; k < operaciones; ++k) {
+                    const string& clave = textos[static_cast<int>(claves * pow(azar(generador), 3.0))];
+                    if (buscarCacheConcurrente(cache, clave, encontrados)) hits[h]++;
+                    else insertarCacheConcurrente(cache, clave, resultados);
+                }
+            };
+            high_resolution_clock::time_point inicio = high_resolution_clock::now();
+            vector<thread> trabajadores;
+            for (int h = 0; h < hilos; ++h) trabajadores.emplace_back(trabajar, h);
+            for (thread& t : trabajadores) t.join();
+            double tiempo = duration<double>(high_resolution_clock::now() - inicio).count();
+            long long totalHits = 0;
+            for (long long x : hits) totalHits += x;
+            cout << setw(10) << numFragmentos << "  " << setw(5) << hilos << "  " << fixed << setprecision(2)
+                 << setw(6) << hilos * operaciones / tiempo / 1e6 << "  " << setprecision(1)
+                 << totalHits * 100.0 / (static_cast<double>(hilos) * operaciones) << "%\n";
+            liberarCacheConcurrente(cache);
+        }
+    }
+    return 0;
+}
+
+// pasa el log de consultas por la cache con cada politica y la misma capacidad (en entradas),
+// como hace el buscador: si no esta se inserta. los resultados no importan para los hits
+int benchmarkPoliticas(const string& archivoConsultas, vector<int> capacidades) {
+    vector<string> consultas = leerConsultas(archivoConsultas);
+    vector<string> claves;
+    for (const string& consulta : consultas) claves.push_back(normalizarConsulta(consulta));
+    if (capacidades.empty()) capacidades = {10, 100, 1000, 10000};
+
+    cout << "--- Politicas de cache con " << claves.size() << " consultas ---\n";
+    cout << "capacidad        LRU    TinyLFU\n";
+    vector<int> resultados;
+    for (int capacidad : capacidades) {
+        cout << setw(9) << capacidad;
+        for (PoliticaCache politica : {POLITICA_LRU, POLITICA_TINYLFU}) {
+            Cache cache;
+            inicializarCache(cache, capacidad, 53, politica);
+            long long hits = 0;
+            for (const string& clave : claves) {
+                if (buscarCache(cache, clave, resultados)) hits++;
+                else insertarCache(cache, clave, resultados);
+            }
+            cout << "  " << fixed << setprecision(2) << setw(8)
+                 << (claves.empty() ? 0.0 : hits * 100.0 / claves.size()) << "%";
+            liberarCache(cache);
+        }
+        cout << "\n";
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    // el de pagerank no necesita el indice
+    if (argc >= 2 && string(argv[1]) == "pagerank") {
+        return benchmarkPageRank(argc >= 3 ? atoi(argv[2]) : 1000000);
+    }
+    if (argc >= 2 && string(argv[1]) == "cache") return benchmarkCache();
+    if (argc >= 3 && string(argv[1]) == "politicas") {
+        vector<int> capacidades;
+        for (int i = 3; i < argc; ++i) capacidades.push_back(atoi(argv[i]));
+        return benchmarkPoliticas(argv[2], capacidades);
+    }
+    if (argc != 5) {
+        cout << "Uso: " << argv[0] << " <interseccion|construccion|bm25> <documentos.dat> <consultas.dat> <stopwords.txt>\n";
+        cout << "     " << argv[0] << " pagerank [maxNodos]\n";
+        cout << "     " << argv[0] << " cache\n";
+        cout << "     " << argv[0] << " politicas <consultas.dat> [capacidad...]\n";
+        return 1;
+    }
+    string prueba = argv[1];
+
+    FiltroStopwords stopwords;
+    cargarStopwords(argv[4], stopwords);
+    IndiceInvertido indice;
+    inicializarIndice(indice);
+
+    high_resolution_clock::time_point inicio = high_resolution_clock::now();
+    int numDocs = construirIndice(indice, argv[2], stopwords);
+    if (numDocs < 0) {
+        liberarIndice(indice);
+        return 1;
+    }
+    double tiempoIndice = duration<double>(high_resolution_clock::now() - inicio).count();
+    cout << "Indice construido: " << numDocs << " documentos, " << indice.numTerminos << " terminos en "
+         << fixed << setprecision(3) << tiempoIndice << " segundos\n";
+
+    // cuanto ocupan las posting lists comprimidas comparado con un nodo de 16 bytes por posting
+    long long numPostings = 0;
+    for (NodoTermino* t = indice.inicio; t != nullptr; t = t->siguiente) numPostings += t->listaDocumentos.numDocs;
+    size_t bytes = memoriaPostings(indice);
+    cout << "Postings: " << numPostings << ", comprimidas en " << bytes << " bytes ("
+         << setprecision(2) << (numPostings ? bytes * 1.0 / numPostings : 0.0) << " bytes por posting, antes 16)\n";
+
+    vector<string> consultas = leerConsultas(argv[3]);
+
+    int codigo = 0;
+    if (prueba == "interseccion") {
+        codigo = benchmarkInterseccion(indice, consultas, stopwords);
+    } else if (prueba == "bm25") {
+        codigo = benchmarkBM25(indice, consultas, stopwords);
+    } else if (prueba == "construccion") {
+        codigo = benchmarkConstruccion(indice, argv[2], stopwords, tiempoIndice);
+    } else {
+        cout << "Prueba desconocida: " << prueba << "\n";
+        codigo = 1;
+    }
+
+    liberarIndice(indice);
+    return codigo;
+}
@@ -1,154 +1,514 @@
 #include "cache.h"
+#include "index.h"
 #include <iostream>
+#include <mutex>
+#include <cstring>
+#include <algorithm>
+
+// una lista vacia
+void iniciarLista(ListaLRU& lista, size_t capacidad) {
+    lista.head = nullptr;
+    lista.tail = nullptr;
+    lista.size = 0;
+    lista.bytes = 0;
+    lista.capacidad = capacidad;
+}
+
+// reparte el limite (elementos o bytes) entre las listas segun la politica
+void repartirCapacidad(Cache& cache, size_t total) {
+    if (cache.politica == POLITICA_TINYLFU) {
+        // 1% para la ventana, del resto el 80% para los protegidos
+        size_t ventana = std::max<size_t>(1, total / 100);
+        size_t principal = total - std::min(total, ventana);
+        iniciarLista(cache.ventana, ventana);
+        iniciarLista(cache.protegida, principal * 8 / 10);
+        iniciarLista(cache.principal, principal);
+    } else {
+        iniciarLista(cache.principal, total);
+        iniciarLista(cache.ventana, 0);
+        iniciarLista(cache.protegida, 0);
+    }
+}
+
+// el sketch con un contador por fila para cada hueco de la tabla (como minimo 16)
+void iniciarSketch(SketchFrecuencia& sketch, int capacidad) {
+    unsigned long long ancho = 16;
+    while (ancho < static_cast<unsigned long long>(capacidad)) ancho *= 2;
+    sketch.contadores.assign(4 * ancho, 0);
+    sketch.mascara = ancho - 1;
+    sketch.sumados = 0;
+    sketch.periodo = 10 * capacidad;
+}
 
 // funcion para inicializar la cache, poner todo en cero
-void inicializarCache(Cache& cache, int capacidad, int numBuckets) {
+void inicializarCache(Cache& cache, int capacidad, int numBuckets, PoliticaCache politica) {
     //le pasamos la capacidad y el numero de buckets para la tabla hash
     cache.capacidad = capacidad;
     cache.size = 0;
+    cache.politica = politica;
+    cache.bytesMaximos = 0;
+    cache.comprimir = false;
+    cache.bytesUsados = 0;
+    cache.expulsados = 0;
+    cache.rechazados = 0;
     
-    // la cache empieza vacia, los punteros head y tail a nulo
-    cache.head = nullptr;
-    cache.tail = nullptr;
+    // la cache empieza vacia, todas las listas sin nodos
+    repartirCapacidad(cache, capacidad);
+    if (politica == POLITICA_TINYLFU) iniciarSketch(cache.sketch, capacidad);
     
-    // preparamos la tabla hash
-    cache.tabla.numBuckets = numBuckets;
-    cache.tabla.buckets.resize(numBuckets, nullptr);
+    // preparamos la tabla hash (potencia de 2 para sacar el hueco con una mascara)
+    int huecos = 8;
+    while (huecos < numBuckets) huecos *= 2;
+    cache.tabla.huecos.assign(huecos, HuecoCache{nullptr, 0});
+    cache.tabla.ocupados = 0;
 }
 
-// nuestra funcion de hash. es la simple de sumar los ascii
-unsigned int hashFunction(const std::string& clave, int numBuckets) {
-    unsigned int hash = 0;
-    
-    //recorremos la clave caracter por caracter y vamos sumando
-    for (char c : clave) {
-        hash += c;
+void limitarBytesCache(Cache& cache, size_t bytesMaximos, bool comprimir) {
+    cache.bytesMaximos = bytesMaximos;
+    cache.comprimir = comprimir;
+    // con 0 se sigue limitando por cantidad (por ejemplo para solo comprimir)
+    repartirCapacidad(cache, bytesMaximos > 0 ? bytesMaximos : cache.capacidad);
+    // el sketch se habia armado para capacidad entradas, pero ahora entran las que quepan en los bytes.
+    // como mucho son tantas como entradas sin resultados entran en el limite, y para eso lo armamos
+    // (un sketch chico haria chocar todas las claves y dividiria demasiado seguido)
+    if (bytesMaximos > 0 && cache.politica == POLITICA_TINYLFU) {
+        size_t entradas = bytesMaximos / (sizeof(NodoCache) + sizeof(HuecoCache));
+        iniciarSketch(cache.sketch, static_cast<int>(std::min<size_t>(std::max<size_t>(entradas, 1), 1 << 26)));
+    }
+}
+
+// multiplica a por b en 128 bits y junta las dos mitades, asi cada bit de la entrada
+// termina afectando a todos los de la salida (la idea de wyhash)
+unsigned long long mezclar(unsigned long long a, unsigned long long b) {
+    unsigned __int128 r = static_cast<unsigned __int128>(a) * b;
+    return static_cast<unsigned long long>(r) ^ static_cast<unsigned long long>(r >> 64);
+}
+
+// nuestra funcion de hash. antes sumabamos los ascii, y las consultas con las mismas letras
+// (o parecidas y cortas) chocaban todas. ahora se procesa de a 8 bytes y se mezcla cada pedazo
+unsigned long long hashClave(const std::string& clave) {
+    const unsigned long long P0 = 0xa0761d6478bd642full, P1 = 0xe7037ed1a0b428dbull;
+    const unsigned long long P2 = 0x8ebc6af09c88c6e3ull, P3 = 0x589965cc75374cc3ull;
+    const char* p = clave.data();
+    size_t n = clave.size();
+    unsigned long long hash = P0 ^ n;
+
+    //recorremos la clave de a 8 caracteres
+    while (n >= 8) {
+        unsigned long long v;
+        std::memcpy(&v, p, 8);
+        hash = mezclar(hash ^ v, P1);
+        p += 8;
+        n -= 8;
+    }
+    // lo que sobra (menos de 8) completado con ceros
+    unsigned long long v = 0;
+    std::memcpy(&v, p, n);
+    hash = mezclar(hash ^ v ^ P2, P3);
+    return mezclar(hash, P1 ^ clave.size());
+}
+
+// busca el nodo de una clave en la tabla, nullptr si no esta
+NodoCache* buscarNodo(const Cache& cache, const std::string& clave, unsigned long long hash) {
+    const std::vector<HuecoCache>& huecos = cache.tabla.huecos;
+    size_t mascara = huecos.size() - 1;
+    unsigned int huella = static_cast<unsigned int>(hash >> 32);
+    // sondeo lineal: seguimos hasta un hueco vacio
+    for (size_t pos = hash & mascara; huecos[pos].nodo; pos = (pos + 1) & mascara) {
+        if (huecos[pos].huella == huella && huecos[pos].nodo->clave == clave) return huecos[pos].nodo;
+    }
+    return nullptr;
+}
+
+// mete el nodo en el primer hueco libre desde su posicion
+void meterEnTabla(TablaHash& tabla, NodoCache* nodo) {
+    size_t mascara = tabla.huecos.size() - 1;
+    size_t pos = nodo->hash & mascara;
+    while (tabla.huecos[pos].nodo) pos = (pos + 1) & mascara;
+    tabla.huecos[pos] = HuecoCache{nodo, static_cast<unsigned int>(nodo->hash >> 32)};
+    tabla.ocupados++;
+}
+
+// cuando la tabla pasa el 70% la duplicamos y volvemos a meter todos los nodos
+// (los hashes ya estan guardados en los nodos, no se recalculan)
+void agrandarTabla(TablaHash& tabla) {
+    std::vector<HuecoCache> viejos;
+    viejos.swap(tabla.huecos);
+    tabla.huecos.assign(viejos.size() * 2, HuecoCache{nullptr, 0});
+    tabla.ocupados = 0;
+    for (const HuecoCache& h : viejos)
+        if (h.nodo) meterEnTabla(tabla, h.nodo);
+}
+
+// saca un nodo de la tabla. en vez de dejar una marca de borrado, corremos hacia atras
+// los que vienen despues y estaban desplazados, asi las busquedas siguen cortando en el primer vacio
+void sacarDeTabla(TablaHash& tabla, NodoCache* nodo) {
+    size_t mascara = tabla.huecos.size() - 1;
+    size_t i = nodo->hash & mascara;
+    while (tabla.huecos[i].nodo != nodo) i = (i + 1) & mascara;
+    for (size_t j = (i + 1) & mascara; tabla.huecos[j].nodo; j = (j + 1) & mascara) {
+        // donde quisiera estar el de j. si su lugar no queda entre i (sin incluir) y j, lo subimos a i
+        size_t k = tabla.huecos[j].nodo->hash & mascara;
+        bool entre = i <= j ? (i < k && k <= j) : (i < k || k <= j);
+        if (!entre) {
+            tabla.huecos[i] = tabla.huecos[j];
+            i = j;
+        }
+    }
+    tabla.huecos[i] = HuecoCache{nullptr, 0};
+    tabla.ocupados--;
+}
+
+// saca un nodo de su lista sin borrarlo
+void desenganchar(ListaLRU& lista, NodoCache* nodo) {
+    if (nodo->prev) nodo->prev->next = nodo->next;
+    else lista.head = nodo->next; // era la cabeza
+    if (nodo->next) nodo->next->prev = nodo->prev;
+    else lista.tail = nodo->prev; // era la cola, la cola ahora es el anterior
+    nodo->prev = nullptr;
+    nodo->next = nullptr;
+    lista.size--;
+    lista.bytes -= nodo->bytes;
+}
+
+// pone un nodo (que no esta en ninguna lista) al principio de una
+void ponerAlFrente(ListaLRU& lista, NodoCache* nodo, int segmento) {
+    nodo->prev = nullptr;
+    nodo->next = lista.head;
+    if (lista.head) lista.head->prev = nodo; //la antigua cabeza ahora apunta al nuevo
+    lista.head = nodo;
+    //si la lista estaba vacia, la cola tambien es este nodo
+    if (!lista.tail) lista.tail = nodo;
+    nodo->segmento = segmento;
+    lista.size++;
+    lista.bytes += nodo->bytes;
+}
+
+// lo que ocupa una lista y un nodo en la unidad del limite: elementos o bytes
+size_t carga(const Cache& cache, const ListaLRU& lista) {
+    return cache.bytesMaximos ? lista.bytes : lista.size;
+}
+
+size_t pesoNodo(const Cache& cache, const NodoCache* nodo) {
+    return cache.bytesMaximos ? nodo->bytes : 1;
+}
+
+// cuanta memoria ocupa un nodo: el nodo, su hueco en la tabla, y lo que la clave
+// y los resultados piden aparte (una clave corta se guarda dentro del mismo string)
+size_t bytesNodo(const NodoCache* nodo) {
+    size_t bytes = sizeof(NodoCache) + sizeof(HuecoCache);
+    const char* propio = reinterpret_cast<const char*>(&nodo->clave);
+    const char* texto = nodo->clave.data();
+    if (texto < propio || texto >= propio + sizeof(std::string)) bytes += nodo->clave.capacity() + 1;
+    return bytes + nodo->resultados.capacity() * sizeof(int) + nodo->comprimidos.capacity();
+}
+
+// guarda los resultados en el nodo (comprimidos si la cache comprime) y anota cuanto ocupa
+// comprimidos: la diferencia con el anterior en zigzag (para que una negativa tambien quede chica)
+// y en VByte. los resultados vienen ordenados, asi que casi todas las diferencias son de 1 byte
+void guardarResultados(Cache& cache, NodoCache* nodo, const std::vector<int>& resultados) {
+    if (cache.comprimir) {
+        std::vector<unsigned char> datos;
+        int anterior = 0;
+        for (int id : resultados) {
+            int diferencia = id - anterior;
+            escribirVByte(datos, (static_cast<unsigned int>(diferencia) << 1) ^ static_cast<unsigned int>(diferencia >> 31));
+            anterior = id;
+        }
+        nodo->comprimidos.assign(datos.begin(), datos.end()); // sin lugar de sobra
+    } else {
+        nodo->resultados = resultados;
+    }
+    nodo->bytes = bytesNodo(nodo);
+}
+
+// copia los resultados del nodo a resultados (descomprimiendo si hace falta)
+void leerResultados(const NodoCache* nodo, std::vector<int>& resultados) {
+    if (nodo->comprimidos.empty()) {
+        resultados = nodo->resultados;
+        return;
+    }
+    resultados.clear();
+    const unsigned char* p = nodo->comprimidos.data();
+    const unsigned char* fin = p + nodo->comprimidos.size();
+    int anterior = 0;
+    while (p < fin) {
+        unsigned int zigzag = leerVByte(p);
+        anterior += static_cast<int>(zigzag >> 1) ^ -static_cast<int>(zigzag & 1);
+        resultados.push_back(anterior);
     }
-    
-    // al final le aplicamos el modulo para que nos de un indice valido
-    return hash % numBuckets;
 }
 
-// esta funcion mueve un nodo para el frente de la lista
+ListaLRU& listaDe(Cache& cache, const NodoCache* nodo) {
+    if (nodo->segmento == SEGMENTO_VENTANA) return cache.ventana;
+    if (nodo->segmento == SEGMENTO_PROTEGIDO) return cache.protegida;
+    return cache.principal;
+}
+
+// esta funcion mueve un nodo para el frente de su lista
 // lo usamos para el LRU, asi el que usamos recien queda como el mas nuevo
 void moverAlFrente(Cache& cache, NodoCache* nodo) {
+    ListaLRU& lista = listaDe(cache, nodo);
     //si ya esta al frente, no hacemos nada
-    if (cache.head == nodo) return;
+    if (lista.head == nodo) return;
+    desenganchar(lista, nodo);
+    ponerAlFrente(lista, nodo, nodo->segmento);
+}
 
-    // aqui lo desconectamos de donde estaba
-    if (nodo->prev) nodo->prev->next = nodo->next;
-    if (nodo->next) nodo->next->prev = nodo->prev;
+// borra un nodo que ya se saco de su lista
+void borrarNodo(Cache& cache, NodoCache* nodo) {
+    sacarDeTabla(cache.tabla, nodo);
+    cache.bytesUsados -= nodo->bytes;
+    delete nodo; // liberamos la memoria del nodo
+    cache.size--;
+}
 
-    // si era la cola, la cola ahora es el anterior
-    if (cache.tail == nodo) cache.tail = nodo->prev;
+// el contador de una fila del sketch para un hash. cada fila usa otra combinacion
+// de las dos mitades del hash, asi dos claves que chocan en una fila casi nunca chocan en todas
+unsigned char& contadorSketch(SketchFrecuencia& sketch, unsigned long long hash, int fila) {
+    unsigned long long salto = (hash >> 32) | 1;
+    return sketch.contadores[fila * (sketch.mascara + 1) + ((hash + fila * salto) & sketch.mascara)];
+}
 
-    // y aca lo ponemos al principio
-    nodo->prev = nullptr;
-    nodo->next = cache.head;
-    if (cache.head) cache.head->prev = nodo; //la antigua cabeza ahora apunta al nuevo
-    cache.head = nodo;
+// suma 1 a la clave (los contadores llegan hasta 15). cuando se sumaron 10 veces la capacidad
+// se dividen todos por 2: lo que fue popular hace mucho deja de ganarle a lo que se pide ahora
+void sumarSketch(SketchFrecuencia& sketch, unsigned long long hash) {
+    for (int fila = 0; fila < 4; ++fila) {
+        unsigned char& contador = contadorSketch(sketch, hash, fila);
+        if (contador < 15) contador++;
+    }
+    if (++sketch.sumados >= sketch.periodo) {
+        for (unsigned char& contador : sketch.contadores) contador >>= 1;
+        sketch.sumados /= 2;
+    }
+}
 
-    //si la lista estaba vacia, la cola tambien es este nodo
-    if (!cache.tail) cache.tail = nodo;
+// cuantas veces se pidio (aproximado, nunca menos de las reales salvo por las divisiones)
+int frecuenciaSketch(SketchFrecuencia& sketch, unsigned long long hash) {
+    int minimo = 15;
+    for (int fila = 0; fila < 4; ++fila) minimo = std::min(minimo, static_cast<int>(contadorSketch(sketch, hash, fila)));
+    return minimo;
 }
 
 // funcion para buscar en la cache. si lo encontramos es un HIT si no es un MISS
-bool buscarCache(Cache& cache, const std::string& clave, std::vector<int>& resultados) {
-    // primero calculamos el hash para saber en que bucket buscar
-    unsigned int index = hashFunction(clave, cache.tabla.numBuckets);
-    EntradaHash* entry = cache.tabla.buckets[index];
-
-    //recorremos la lista de colisiones de ese bucket
-    while (entry) {
-        // si la clave es la misma, es un hit
-        if (entry->clave == clave) {
-            // devolvemos los resultados
-            resultados = entry->nodo->resultados;
-            // movemos el nodo al frente para actualizar el LRU
-            moverAlFrente(cache, entry->nodo);
-            return true;
+bool buscarCacheHash(Cache& cache, const std::string& clave, unsigned long long hash, std::vector<int>& resultados) {
+    // con TinyLFU se cuentan todos los pedidos, esten o no en la cache
+    if (cache.politica == POLITICA_TINYLFU) sumarSketch(cache.sketch, hash);
+    NodoCache* nodo = buscarNodo(cache, clave, hash);
+    // si no esta es un miss
+    if (!nodo) return false;
+    // devolvemos los resultados
+    leerResultados(nodo, resultados);
+    if (nodo->segmento == SEGMENTO_PRINCIPAL && cache.politica == POLITICA_TINYLFU) {
+        // se pidio de nuevo estando a prueba: pasa a los protegidos, y si no caben
+        // el mas viejo de los protegidos vuelve a la de prueba
+        desenganchar(cache.principal, nodo);
+        ponerAlFrente(cache.protegida, nodo, SEGMENTO_PROTEGIDO);
+        while (carga(cache, cache.protegida) > cache.protegida.capacidad && cache.protegida.tail != nodo) {
+            NodoCache* viejo = cache.protegida.tail;
+            desenganchar(cache.protegida, viejo);
+            ponerAlFrente(cache.principal, viejo, SEGMENTO_PRINCIPAL);
         }
-        // si no era seguimos buscando en la lista
-        entry = entry->siguiente;
+    } else {
+        // movemos el nodo al frente para actualizar el LRU
+        moverAlFrente(cache, nodo);
     }
-    // si salimos del while es porque no estaba (miss)
-    return false;
+    return true;
 }
 
-// funcion para meter algo nuevo en la cache
-void insertarCache(Cache& cache, const std::string& clave, const std::vector<int>& resultados) {
-    // primero vemos si la cache esta llena
-    if (cache.size >= cache.capacidad) {
-        //si esta llena hay que eliminar al mas viejo (el LRU) 
-        NodoCache* lru = cache.tail;
-
-        //borrarlo de la tabla hash
-        unsigned int idx = hashFunction(lru->clave, cache.tabla.numBuckets);
-        EntradaHash* prev = nullptr;
-        EntradaHash* entry = cache.tabla.buckets[idx];
-
-        while (entry) {
-            //buscamos en la lista de colision y lo sacamos
-            if (entry->clave == lru->clave) {
-                if (prev) prev->siguiente = entry->siguiente;
-                else cache.tabla.buckets[idx] = entry->siguiente;
-                delete entry;
-                break;
-            }
-            prev = entry;
-            entry = entry->siguiente;
+bool buscarCache(Cache& cache, const std::string& clave, std::vector<int>& resultados) {
+    return buscarCacheHash(cache, clave, hashClave(clave), resultados);
+}
+
+// con TinyLFU: el mas viejo de la ventana tiene que salir de ahi. si en la parte principal
+// hay lugar entra a prueba, si no compite con el que saldria de la principal y se queda
+// el que se pidio mas veces (si empatan se queda el que ya estaba). con limite de bytes
+// puede tener que ganarle a varios hasta que haya lugar: primero se mira que le gane a todos
+// y recien ahi se sacan, asi si pierde contra alguno no se saco a nadie de gusto.
+// devuelve false si el candidato no se quedo
+bool admitirDesdeVentana(Cache& cache) {
+    NodoCache* candidato = cache.ventana.tail;
+    desenganchar(cache.ventana, candidato);
+    size_t usado = carga(cache, cache.principal) + carga(cache, cache.protegida);
+    int frecuencia = frecuenciaSketch(cache.sketch, candidato->hash);
+    // las victimas son los mas viejos a prueba y despues (si no alcanza) los mas viejos protegidos
+    NodoCache* victima = cache.principal.tail ? cache.principal.tail : cache.protegida.tail;
+    size_t liberado = 0;
+    int numVictimas = 0;
+    while (usado - liberado + pesoNodo(cache, candidato) > cache.principal.capacidad) {
+        if (!victima || frecuencia <= frecuenciaSketch(cache.sketch, victima->hash)) {
+            borrarNodo(cache, candidato);
+            cache.rechazados++;
+            return false;
         }
+        liberado += pesoNodo(cache, victima);
+        numVictimas++;
+        if (victima->prev) victima = victima->prev;
+        else victima = victima->segmento == SEGMENTO_PRINCIPAL ? cache.protegida.tail : nullptr;
+    }
+    for (int i = 0; i < numVictimas; ++i) {
+        ListaLRU& deVictima = cache.principal.size > 0 ? cache.principal : cache.protegida;
+        NodoCache* expulsado = deVictima.tail;
+        desenganchar(deVictima, expulsado);
+        borrarNodo(cache, expulsado);
+        cache.expulsados++;
+    }
+    ponerAlFrente(cache.principal, candidato, SEGMENTO_PRINCIPAL);
+    return true;
+}
 
-        // y ahora lo borramos de la lista doblemente enlazada
-        if (lru->prev) lru->prev->next = nullptr;
-        cache.tail = lru->prev; //actualizamos el puntero tail
-        delete lru; // liberamos la memoria del nodo
-        cache.size--;
+// funcion para meter algo nuevo en la cache
+bool insertarCacheHash(Cache& cache, const std::string& clave, unsigned long long hash,
+                       const std::vector<int>& resultados) {
+    // creamos el nodo, asi sabemos cuanto ocupa
+    NodoCache* nuevo = new NodoCache{clave, {}, {}, nullptr, nullptr, hash, SEGMENTO_PRINCIPAL, 0};
+    guardarResultados(cache, nuevo, resultados);
+    // si no entra ni con la cache vacia no lo guardamos
+    if (pesoNodo(cache, nuevo) > cache.ventana.capacidad + cache.principal.capacidad) {
+        delete nuevo;
+        cache.rechazados++;
+        return false;
     }
 
-    // metemos el nuevo
-    // creamos el nodo y lo ponemos al principio (head)
-    NodoCache* nuevo = new NodoCache{clave, resultados, nullptr, cache.head};
-    if (cache.head) cache.head->prev = nuevo;
-    cache.head = nuevo;
-    if (!cache.tail) cache.tail = nuevo;
+    // con LRU primero vemos si la cache esta llena
+    while (cache.politica == POLITICA_LRU &&
+           carga(cache, cache.principal) + pesoNodo(cache, nuevo) > cache.principal.capacidad) {
+        //si esta llena hay que eliminar al mas viejo (el LRU) 
+        NodoCache* lru = cache.principal.tail;
+        desenganchar(cache.principal, lru);
+        borrarNodo(cache, lru);
+        cache.expulsados++;
+    }
 
-    // y lo metemos tambien en la tabla hash
-    unsigned int index = hashFunction(clave, cache.tabla.numBuckets);
-    EntradaHash* nuevaEntrada = new EntradaHash{clave, nuevo, cache.tabla.buckets[index]};
-    cache.tabla.buckets[index] = nuevaEntrada;
+    // metemos el nuevo, al principio (head)
+    ponerAlFrente(cache.politica == POLITICA_TINYLFU ? cache.ventana : cache.principal, nuevo,
+                  cache.politica == POLITICA_TINYLFU ? SEGMENTO_VENTANA : SEGMENTO_PRINCIPAL);
 
+    // y lo metemos tambien en la tabla hash (agrandandola si hace falta)
+    if ((cache.tabla.ocupados + 1) * 10 > static_cast<int>(cache.tabla.huecos.size()) * 7) agrandarTabla(cache.tabla);
+    meterEnTabla(cache.tabla, nuevo);
     cache.size++;
+    cache.bytesUsados += nuevo->bytes;
+
+    // con TinyLFU los que no caben en la ventana pasan de a uno, y ahi se decide quien queda.
+    // con limite de bytes el nuevo puede ser uno de los que pasan
+    bool guardado = true;
+    while (cache.politica == POLITICA_TINYLFU && carga(cache, cache.ventana) > cache.ventana.capacidad) {
+        bool esNuevo = cache.ventana.tail == nuevo;
+        if (!admitirDesdeVentana(cache) && esNuevo) guardado = false;
+    }
+    return guardado;
 }
 
-// para que no hayan memory leaks, liberamos todo
-void liberarCache(Cache& cache) {
-    // primero la lista doble
-    NodoCache* actual = cache.head;
+bool insertarCache(Cache& cache, const std::string& clave, const std::vector<int>& resultados) {
+    return insertarCacheHash(cache, clave, hashClave(clave), resultados);
+}
+
+// borra todos los nodos de una lista
+void liberarLista(ListaLRU& lista) {
+    NodoCache* actual = lista.head;
     while (actual) {
         NodoCache* temp = actual;
         actual = actual->next;
         delete temp;
     }
+    iniciarLista(lista, 0);
+}
 
-    // y despues la tabla hash, bucket por bucket
-    for (auto bucket : cache.tabla.buckets) {
-        while (bucket) {
-            EntradaHash* temp = bucket;
-            bucket = bucket->siguiente;
-            delete temp;
-        }
-    }
+// para que no hayan memory leaks, liberamos todo
+void liberarCache(Cache& cache) {
+    // las listas tienen todos los nodos (la tabla solo apunta a ellos)
+    liberarLista(cache.principal);
+    liberarLista(cache.ventana);
+    liberarLista(cache.protegida);
+    cache.size = 0;
+    cache.bytesUsados = 0;
+    std::vector<HuecoCache>().swap(cache.tabla.huecos);
+    cache.tabla.ocupados = 0;
+    std::vector<unsigned char>().swap(cache.sketch.contadores);
 }
 
-// funcion para ver como esta la cache, mas que nada para debuggear
-void mostrarEstadoCache(const Cache& cache) {
-    std::cout << "\n--- Estado de la cache (MRU -> LRU) ---\n";
-    // imprime desde el mas nuevo (head) al mas viejo (tail)
-    NodoCache* actual = cache.head;
+// imprime una lista desde el mas nuevo (head) al mas viejo (tail)
+void mostrarLista(const ListaLRU& lista) {
+    NodoCache* actual = lista.head;
     while (actual) {
         std::cout << "\"" << actual->clave << "\" -> ";
         actual = actual->next;
     }
     std::cout << "NULL\n";
 }
+
+// funcion para ver como esta la cache, mas que nada para debuggear
+void mostrarEstadoCache(const Cache& cache) {
+    std::cout << "\n--- Estado de la cache (MRU -> LRU) ---\n";
+    if (cache.politica == POLITICA_TINYLFU) {
+        std::cout << "ventana: ";
+        mostrarLista(cache.ventana);
+        std::cout << "protegidos: ";
+        mostrarLista(cache.protegida);
+        std::cout << "a prueba: ";
+    }
+    mostrarLista(cache.principal);
+}
+
+const char* nombrePolitica(PoliticaCache politica) {
+    return politica == POLITICA_TINYLFU ? "TinyLFU" : "LRU";
+}
+
+bool leerPolitica(const std::string& nombre, PoliticaCache& politica) {
+    if (nombre == "lru" || nombre == "LRU") politica = POLITICA_LRU;
+    else if (nombre == "tinylfu" || nombre == "TinyLFU") politica = POLITICA_TINYLFU;
+    else return false;
+    return true;
+}
+
+// el fragmento sale de los bits altos del hash y el hueco de los bajos,
+// asi las claves de un mismo fragmento no se amontonan en la tabla
+FragmentoCache& fragmentoDe(CacheConcurrente& cache, unsigned long long hash) {
+    return cache.fragmentos[(hash >> 40) % cache.numFragmentos];
+}
+
+void inicializarCacheConcurrente(CacheConcurrente& cache, int capacidad, int numFragmentos, int numBuckets) {
+    cache.numFragmentos = numFragmentos;
+    cache.fragmentos = new FragmentoCache[numFragmentos];
+    int porFragmento = (capacidad + numFragmentos - 1) / numFragmentos;
+    for (int i = 0; i < numFragmentos; ++i)
+        inicializarCache(cache.fragmentos[i].cache, porFragmento, numBuckets, POLITICA_LRU);
+}
+
+bool buscarCacheConcurrente(CacheConcurrente& cache, const std::string& clave, std::vector<int>& resultados) {
+    unsigned long long hash = hashClave(clave); // fuera del candado
+    FragmentoCache& fragmento = fragmentoDe(cache, hash);
+    std::lock_guard<std::mutex> lock(fragmento.candado);
+    return buscarCacheHash(fragmento.cache, clave, hash, resultados);
+}
+
+void insertarCacheConcurrente(CacheConcurrente& cache, const std::string& clave, const std::vector<int>& resultados) {
+    unsigned long long hash = hashClave(clave);
+    FragmentoCache& fragmento = fragmentoDe(cache, hash);
+    std::lock_guard<std::mutex> lock(fragmento.candado);
+    // dos hilos pueden fallar con la misma clave y querer insertarla los dos,
+    // el segundo solo la pasa al frente para que no quede repetida
+    NodoCache* nodo = buscarNodo(fragmento.cache, clave, hash);
+    if (nodo) {
+        moverAlFrente(fragmento.cache, nodo);
+        return;
+    }
+    insertarCacheHash(fragmento.cache, clave, hash, resultados);
+}
+
+int tamCacheConcurrente(CacheConcurrente& cache) {
+    int total = 0;
+    for (int i = 0; i < cache.numFragmentos; ++i) {
+        std::lock_guard<std::mutex> lock(cache.fragmentos[i].candado);
+        total += cache.fragmentos[i].cache.size;
+    }
+    return total;
+}
+
+void liberarCacheConcurrente(CacheConcurrente& cache) {
+    for (int i = 0; i < cache.numFragmentos; ++i) liberarCache(cache.fragmentos[i].cache);
+    delete[] cache.fragmentos;
+    cache.fragmentos = nullptr;
+    cache.numFragmentos = 0;
+}
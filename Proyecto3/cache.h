@@ -3,52 +3,134 @@
 
 #include <string>
 #include <vector>
+#include <mutex>
 
 // para evitar que se incluya el archivo mas de una vez
 // esto es lo que va en la lista doblemente enlazada (la del LRU)
+// es lo unico que se pide por cada entrada: la clave se guarda solo aca, la tabla hash apunta al nodo
 struct NodoCache {
     std::string clave;              // la consulta que se guardo
-    std::vector<int> resultados;    // el vector con los ids de los docs
+    std::vector<int> resultados;    // el vector con los ids de los docs (vacio si se guardan comprimidos)
+    std::vector<unsigned char> comprimidos; // o los ids comprimidos: diferencias en VByte
     NodoCache* prev;                // puntero al de atras
     NodoCache* next;                // puntero al de adelante
+    unsigned long long hash;        // el hash de la clave, para no recalcularlo al agrandar o borrar
+    int segmento;                   // en que lista esta (SEGMENTO_...)
+    size_t bytes;                   // lo que ocupa en memoria: el nodo, su hueco, la clave y los resultados
 };
 
-// esto es para la tabla hash, cada entrada en la tabla
-struct EntradaHash {
-    std::string clave;
-    NodoCache* nodo;                //  un puntero al nodo de la lista, para encontrarlo rapido
-    EntradaHash* siguiente;         // el puntero al siguiente por si hay colision
+// las listas donde puede estar un nodo. con LRU todos estan en la principal
+const int SEGMENTO_PRINCIPAL = 0;   // con TinyLFU es la de prueba: los que entraron y todavia no se repitieron
+const int SEGMENTO_VENTANA = 1;     // TinyLFU: los recien llegados
+const int SEGMENTO_PROTEGIDO = 2;   // TinyLFU: los que se pidieron de nuevo estando en la de prueba
+
+// una lista doblemente enlazada del mas nuevo (head) al mas viejo (tail)
+struct ListaLRU {
+    NodoCache* head;    // la cabeza de la lista
+    NodoCache* tail;    // la cola de la lista (el que borramos)
+    int size;           // cuantos nodos tiene
+    size_t bytes;       // lo que ocupan sus nodos
+    size_t capacidad;   // cuantos nodos (o bytes, si la cache se limita por bytes) puede tener antes de pasar el ultimo a otra lista
+};
+
+// un hueco de la tabla hash: el nodo y unos bits del hash para descartar sin mirar la clave
+struct HuecoCache {
+    NodoCache* nodo;                // nullptr = vacio
+    unsigned int huella;            // los 32 bits altos del hash
 };
 
 // La estructura de la tabla hash en si
+// direccionamiento abierto con sondeo lineal, se duplica cuando se llena mas del 70%
 struct TablaHash {
-    std::vector<EntradaHash*> buckets;  // el array de buckets
-    int numBuckets;                     // cuantos buckets tiene la tabla
+    std::vector<HuecoCache> huecos; // potencia de 2
+    int ocupados;                   // cuantos huecos tienen un nodo
+};
+
+// como se elige a quien sacar cuando la cache esta llena
+// LRU: siempre sale el que se uso hace mas tiempo. el problema es que una pasada de consultas
+// que no se repiten (la cola larga del log) va empujando y saca a todas las populares.
+// TINYLFU (W-TinyLFU): los nuevos entran a una ventana LRU chica (1%) y cuando salen de ahi
+// solo se quedan si se pidieron mas veces que el que tendrian que sacar de la parte principal.
+// las veces se cuentan aproximadas en un sketch chico, tambien para claves que ya no estan
+enum PoliticaCache { POLITICA_LRU, POLITICA_TINYLFU };
+
+// cuantas veces se pidio cada clave, aproximado (count-min sketch):
+// 4 filas de contadores, cada clave suma en un contador de cada fila y se toma el menor.
+// cada tantas sumas se dividen todos por 2, asi lo viejo va pesando menos
+struct SketchFrecuencia {
+    std::vector<unsigned char> contadores;  // 4 filas de ancho contadores (hasta 15)
+    unsigned long long mascara;             // ancho - 1 (potencia de 2)
+    int sumados;                            // cuantas sumas desde la ultima division
+    int periodo;                            // cada cuantas sumas se divide (10 veces las entradas que caben)
 };
 
 // La estructura principal de la Cache
-// juntamos la tabla hash y la lista del lru
+// juntamos la tabla hash y las listas del lru
 struct Cache {
-    int capacidad;      // cuantos elementos caben como maximo
+    int capacidad;      // cuantos elementos caben como maximo (con limite de bytes es solo lo que se espera)
     int size;           // cuantos elementos hay ahora
+    size_t bytesMaximos; // 0 = se limita por cantidad de elementos, si no por lo que ocupan
+    bool comprimir;     // guardar los resultados comprimidos (mas lento de leer, ocupan ~4 veces menos)
+    size_t bytesUsados; // lo que ocupan las entradas ahora (se cuenta siempre)
+    long long expulsados; // cuantas entradas que estaban se sacaron para hacer lugar
+    long long rechazados; // cuantas nuevas no se quedaron: no entraban, o (TinyLFU) al salir de la ventana
+                          // no le ganaron a las que habia que sacar
     TablaHash tabla;    // nuestra tabla hash
-    NodoCache* head;    // la cabeza de la lista
-    NodoCache* tail;    // la cola de la lista (el que borramos)
+    PoliticaCache politica;
+    ListaLRU principal; // con LRU estan todos aca
+    ListaLRU ventana;   // solo TinyLFU
+    ListaLRU protegida; // solo TinyLFU
+    SketchFrecuencia sketch; // solo TinyLFU
 };
 
 // prototipos de las funciones 
 
-// para empezar la cache desde cero
-void inicializarCache(Cache& cache, int capacidad, int numBuckets);
+// para empezar la cache desde cero (numBuckets es el tamaño inicial de la tabla, despues crece sola)
+void inicializarCache(Cache& cache, int capacidad, int numBuckets, PoliticaCache politica);
+// para limitar la cache por bytes en vez de por cantidad (llamarla con la cache vacia).
+// una consulta con muchos resultados ocupa lo que ocupan sus resultados, y cabe una sola
+// o muchas chicas segun el caso. con bytesMaximos 0 sigue el limite por cantidad.
+// si comprimir es true los ids se guardan en VByte. con TinyLFU el sketch se vuelve a armar
+// para las entradas que pueden entrar en esos bytes
+void limitarBytesCache(Cache& cache, size_t bytesMaximos, bool comprimir);
 // busca algo en la cache, devuelve true si lo encuentra
 bool buscarCache(Cache& cache, const std::string& clave, std::vector<int>& resultados);
-// para meter algo nuevo
-void insertarCache(Cache& cache, const std::string& clave, const std::vector<int>& resultados);
+// para meter algo nuevo. devuelve false si no se guardo (no entra ni con la cache vacia, o con
+// TinyLFU pasa de largo por la ventana y pierde la admision)
+bool insertarCache(Cache& cache, const std::string& clave, const std::vector<int>& resultados);
 // para borrar todo y liberar memoria
 void liberarCache(Cache& cache);
 // una funcion para ver como esta la cache, para debug
 void mostrarEstadoCache(const Cache& cache);
-// la funcion que convierte el string a numero
-unsigned int hashFunction(const std::string& clave, int numBuckets);
+// el nombre de la politica ("LRU", "TinyLFU") y al reves, devuelve false si no la conoce
+const char* nombrePolitica(PoliticaCache politica);
+bool leerPolitica(const std::string& nombre, PoliticaCache& politica);
+// la funcion que convierte el string a numero (64 bits, mezcla de a 8 bytes con multiplicaciones)
+unsigned long long hashClave(const std::string& clave);
+
+// para usar la cache desde varios hilos a la vez (por ejemplo un servidor que atiende
+// varias consultas juntas). la cache se parte en fragmentos segun el hash de la clave y
+// cada fragmento es una Cache normal con su propio candado, asi dos hilos solo se esperan
+// si buscan claves del mismo fragmento. el LRU es por fragmento, no de toda la cache
+struct FragmentoCache {
+    std::mutex candado;
+    Cache cache;
+};
+
+struct CacheConcurrente {
+    int numFragmentos;
+    FragmentoCache* fragmentos;     // numFragmentos, cada uno con capacidad / numFragmentos
+};
+
+// la capacidad se reparte entre los fragmentos (redondeando para arriba)
+void inicializarCacheConcurrente(CacheConcurrente& cache, int capacidad, int numFragmentos, int numBuckets);
+// igual que buscarCache pero se puede llamar desde cualquier hilo
+bool buscarCacheConcurrente(CacheConcurrente& cache, const std::string& clave, std::vector<int>& resultados);
+// igual que insertarCache, pero si otro hilo ya la inserto solo la pasa al frente
+// (los dos la buscaron en el mismo indice, asi que tienen los mismos resultados)
+void insertarCacheConcurrente(CacheConcurrente& cache, const std::string& clave, const std::vector<int>& resultados);
+// cuantos elementos hay en total (sumando todos los fragmentos)
+int tamCacheConcurrente(CacheConcurrente& cache);
+void liberarCacheConcurrente(CacheConcurrente& cache);
 
 #endif // CACHE_H
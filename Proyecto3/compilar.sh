@@ -1,11 +1,11 @@
 #!/bin/bash
 echo "🔧 Compilando proyecto "
 
-g++ -o buscador main.cpp index.cpp utils.cpp grafo.cpp cache.cpp
+g++ -O2 -pthread -o buscador main.cpp index.cpp utils.cpp grafo.cpp cache.cpp interseccion.cpp segmento.cpp ranking.cpp documentos.cpp &&
+g++ -O2 -pthread -o benchmark benchmark.cpp index.cpp utils.cpp grafo.cpp cache.cpp interseccion.cpp segmento.cpp ranking.cpp documentos.cpp
 
 if [ $? -eq 0 ]; then
     echo "✅ Compilación exitosa."
 else
     echo "❌ Error en la compilación."
 fi
-
@@ -0,0 +1,100 @@
+#include "documentos.h"
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+// si no se puede mapear, se lee de a pedazos de este tamaño
+const size_t TAM_PEDAZO = 1 << 22; // 4 MB
+
+bool abrirDocumentos(const std::string& archivo, ArchivoDocumentos& documentos) {
+    documentos.datos = nullptr;
+    documentos.tam = 0;
+    documentos.mapeado = false;
+    documentos.memoria.clear();
+    int fd = open(archivo.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        return false;
+    }
+#ifdef POSIX_FADV_SEQUENTIAL
+    // lo vamos a leer de principio a fin: que el sistema lea por adelantado
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    if (S_ISREG(info.st_mode) && info.st_size > 0) {
+        void* mapa = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapa != MAP_FAILED) {
+            madvise(mapa, info.st_size, MADV_SEQUENTIAL);
+            close(fd); // el mapa sigue valido aunque cerremos el descriptor
+            documentos.datos = static_cast<const char*>(mapa);
+            documentos.tam = info.st_size;
+            documentos.mapeado = true;
+            return true;
+        }
+    }
+
+    // no se pudo mapear (o no es un archivo normal): lo leemos entero a memoria
+    size_t leidos = 0;
+    while (true) {
+        documentos.memoria.resize(leidos + TAM_PEDAZO);
+        ssize_t n = read(fd, documentos.memoria.data() + leidos, TAM_PEDAZO);
+        if (n <= 0) break;
+        leidos += static_cast<size_t>(n);
+    }
+    close(fd);
+    documentos.memoria.resize(leidos);
+    documentos.datos = documentos.memoria.data();
+    documentos.tam = leidos;
+    return true;
+}
+
+void iniciarCursorDocumentos(const ArchivoDocumentos& documentos, size_t inicio, size_t fin,
+                             CursorDocumentos& cursor) {
+    if (fin > documentos.tam) fin = documentos.tam;
+    if (inicio > fin) inicio = fin;
+    cursor.actual = documentos.datos + inicio;
+    cursor.fin = documentos.datos + fin;
+    cursor.finArchivo = documentos.datos + documentos.tam;
+    // si no caimos justo al principio de una linea, esa linea es del rango anterior
+    if (inicio > 0 && documentos.datos[inicio - 1] != '\n') {
+        const char* salto = static_cast<const char*>(memchr(cursor.actual, '\n', cursor.finArchivo - cursor.actual));
+        cursor.actual = salto ? salto + 1 : cursor.finArchivo;
+    }
+}
+
+bool siguienteLinea(CursorDocumentos& cursor, std::string_view& linea) {
+    if (cursor.actual >= cursor.fin) return false;
+    const char* salto = static_cast<const char*>(memchr(cursor.actual, '\n', cursor.finArchivo - cursor.actual));
+    const char* finLinea = salto ? salto : cursor.finArchivo; // la ultima linea puede no tener salto
+    linea = std::string_view(cursor.actual, finLinea - cursor.actual);
+    cursor.actual = salto ? salto + 1 : cursor.finArchivo;
+    return true;
+}
+
+bool contenidoDocumento(std::string_view linea, std::string_view& contenido) {
+    // buscamos el ultimo '|' desde atras (memrchr) y nos fijamos si el de antes tambien es '|'
+    const char* inicio = linea.data();
+    size_t largo = linea.size();
+    while (largo >= 2) {
+        const char* barra = static_cast<const char*>(memrchr(inicio, '|', largo));
+        if (!barra || barra == inicio) return false;
+        if (barra[-1] == '|') {
+            contenido = std::string_view(barra + 1, inicio + linea.size() - barra - 1);
+            return true;
+        }
+        largo = barra - inicio; // sigue buscando antes de esta barra suelta
+    }
+    return false;
+}
+
+void cerrarDocumentos(ArchivoDocumentos& documentos) {
+    if (documentos.mapeado) munmap(const_cast<char*>(documentos.datos), documentos.tam);
+    std::vector<char>().swap(documentos.memoria);
+    documentos.datos = nullptr;
+    documentos.tam = 0;
+    documentos.mapeado = false;
+}
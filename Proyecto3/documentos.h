@@ -0,0 +1,47 @@
+#ifndef DOCUMENTOS_H
+#define DOCUMENTOS_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+// para que no se incluya dos veces
+// aqui va todo lo de leer el archivo de documentos (una linea por doc, el contenido despues
+// del ultimo "||"). en vez de getline + substr, el archivo se mapea entero en memoria y se
+// recorre buscando los saltos de linea con memchr, asi cada doc es un pedazo del mismo archivo
+// (string_view) y no se copia nada. varios hilos pueden leer rangos distintos del mismo mapa
+
+// el archivo abierto
+struct ArchivoDocumentos {
+    const char* datos;              // donde empieza el archivo
+    size_t tam;                     // cuantos bytes tiene
+    bool mapeado;                   // true si viene de mmap, false si se leyo a memoria
+    std::vector<char> memoria;      // los bytes si no se pudo mapear
+};
+
+// recorre las lineas de un rango del archivo
+struct CursorDocumentos {
+    const char* actual;             // donde empieza la proxima linea
+    const char* fin;                // las lineas que empiezan desde aca ya no son del rango
+    const char* finArchivo;         // una linea puede terminar despues de fin
+};
+
+// abre el archivo con mmap (avisandole al sistema que se va a leer de principio a fin, asi lee
+// adelantado). si no se puede mapear se lee entero de a pedazos grandes. devuelve false si no existe
+bool abrirDocumentos(const std::string& archivo, ArchivoDocumentos& documentos);
+
+// para recorrer las lineas que empiezan entre los bytes inicio y fin (si inicio cae en la mitad
+// de una linea, esa es del rango anterior). con 0 y documentos.tam se recorre todo
+void iniciarCursorDocumentos(const ArchivoDocumentos& documentos, size_t inicio, size_t fin,
+                             CursorDocumentos& cursor);
+
+// deja en linea la siguiente linea (sin el salto), devuelve false cuando se acaba el rango
+bool siguienteLinea(CursorDocumentos& cursor, std::string_view& linea);
+
+// el contenido de un doc: lo que esta despues del ultimo "||". devuelve false si no tiene
+bool contenidoDocumento(std::string_view linea, std::string_view& contenido);
+
+// para desmapear o liberar el archivo
+void cerrarDocumentos(ArchivoDocumentos& documentos);
+
+#endif // DOCUMENTOS_H
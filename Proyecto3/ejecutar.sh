@@ -1,4 +1,4 @@
 #!/bin/bash
 echo "🚀 Ejecutando buscador completo..."
 
-./buscador gov2_pages.dat Log-Queries.dat stopwords_english.dat.txt
+./buscador gov2_pages.dat Log-Queries.dat stopwords_english.dat.txt --indice gov2_pages.idx
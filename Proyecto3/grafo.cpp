@@ -1,35 +1,82 @@
 #include <cmath>
 #include <iostream>
 #include <iomanip>
+#include <algorithm>
+#include <utility>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <new>
 #include "grafo.h"
 
 using namespace std;
 
+// capacidad inicial de la tabla de ids, tiene que ser potencia de 2
+const int CAPACIDAD_INICIAL_IDS = 1024;
+
+// actualizarPageRank: cuanto residuo puede quedarle a un nodo en proporcion a su pagerank, y
+// cuanto puede empujar en proporcion a lo que toco el lote antes de rendirse e iterar
+const double RESIDUO_RELATIVO = 1e-5;
+const long long EMPUJES_POR_CAMBIO = 64;
+
 // funcion para preparar el grafo, lo dejamos listo y vacio
-void inicializarGrafo(Grafo& grafo, int maxNodos) {
+void inicializarGrafo(Grafo& grafo) {
     grafo.numNodos = 0;
     grafo.numAristas = 0;
-    // reservamos memoria para todo con new
-    grafo.ids = new int[maxNodos];
-    grafo.pageRank = new double[maxNodos];
-    grafo.adyacencia = new int*[maxNodos];
-    // la matriz de adyacencia la inicializamos en cero
-    for (int i = 0; i < maxNodos; ++i) {
-        grafo.adyacencia[i] = new int[maxNodos]();
+    grafo.ids.clear();
+    grafo.pageRank.clear();
+    grafo.tablaIds.assign(CAPACIDAD_INICIAL_IDS, 0);
+    grafo.aristasPendientes.clear();
+    // el CSR vacio: cero nodos, un solo inicio
+    grafo.inicioVecinos.assign(1, 0);
+    grafo.vecinos.clear();
+    grafo.pesos.clear();
+    grafo.inversoGrado.clear();
+    grafo.nodosCambiados.clear();
+}
+
+// el hueco donde empieza a buscar un id (multiplicativo, los ids son numeros seguidos)
+unsigned int huecoId(int id, unsigned int mascara) {
+    return (static_cast<unsigned int>(id) * 2654435761u) & mascara;
+}
+
+// cuando la tabla se llena mas del 70% la duplicamos y volvemos a meter todos los ids
+void agrandarTablaIds(Grafo& grafo) {
+    vector<int> nueva(grafo.tablaIds.size() * 2, 0);
+    unsigned int mascara = static_cast<unsigned int>(nueva.size()) - 1;
+    for (int i = 0; i < grafo.numNodos; ++i) {
+        unsigned int pos = huecoId(grafo.ids[i], mascara);
+        while (nueva[pos] != 0) pos = (pos + 1) & mascara;
+        nueva[pos] = i + 1;
     }
+    grafo.tablaIds.swap(nueva);
 }
 
 // esta funcion es para mapear el ID de un documento  a un indice del array (0, 1, 2, etc)
 int obtenerIndice(Grafo& grafo, int id) {
-    // revisa si ya existe
-    for (int i = 0; i < grafo.numNodos; ++i)
-        if (grafo.ids[i] == id)
-            return i; // si lo encontramos, devolvemos su posicion
+    // revisa si ya existe (en la tabla hash, sin recorrer todos los nodos)
+    unsigned int mascara = static_cast<unsigned int>(grafo.tablaIds.size()) - 1;
+    unsigned int pos = huecoId(id, mascara);
+    while (grafo.tablaIds[pos] != 0) {
+        if (grafo.ids[grafo.tablaIds[pos] - 1] == id)
+            return grafo.tablaIds[pos] - 1; // si lo encontramos, devolvemos su posicion
+        pos = (pos + 1) & mascara;
+    }
 
     // si no existe, lo agregamos al final
-    grafo.ids[grafo.numNodos] = id;
+    grafo.ids.push_back(id);
+    grafo.tablaIds[pos] = grafo.numNodos + 1;
     // y devolvemos su nueva posicion, aumentando el contador de nodos
-    return grafo.numNodos++;
+    int nuevo = grafo.numNodos++;
+    if (grafo.numNodos * 10 > static_cast<int>(grafo.tablaIds.size()) * 7) agrandarTablaIds(grafo);
+    return nuevo;
+}
+
+// la clave de una arista dirigida i -> j, ordenar las claves es ordenar por (i, j)
+unsigned long long claveArista(int i, int j) {
+    return (static_cast<unsigned long long>(i) << 32) | static_cast<unsigned int>(j);
 }
 
 // para agregar una  arista entre dos documentos
@@ -38,85 +85,557 @@ void agregarArista(Grafo& grafo, int id1, int id2) {
     int i = obtenerIndice(grafo, id1);
     int j = obtenerIndice(grafo, id2);
 
-    // si no existia una arista la creamos
-    if (!grafo.adyacencia[i][j]) {
-        // ponemos un 1 en la matriz. como es no dirigido, lo hacemos en ambos sentidos (i,j) y (j,i)
-        grafo.adyacencia[i][j] = 1;
-        grafo.adyacencia[j][i] = 1;
-        // aumentamos el contador de aristas
-        grafo.numAristas++;
+    // la anotamos en la lista, las repetidas se juntan al congelar
+    grafo.aristasPendientes.push_back(claveArista(i, j));
+}
+
+// agrega el vecino j al CSR que se esta armando, juntandolo con el anterior si es el mismo
+void agregarVecino(vector<int>& vecinos, vector<int>& pesos, int inicioNodo, int j, int peso) {
+    if (static_cast<int>(vecinos.size()) > inicioNodo && vecinos.back() == j) {
+        pesos.back() += peso;
+    } else {
+        vecinos.push_back(j);
+        pesos.push_back(peso);
     }
 }
 
-// la funcion principal para calcular el pagerank
-int calcularPageRank(Grafo& grafo, int maxIter, double damping) {
+// mete aristas dirigidas (ordenadas por clave, con su peso) en el CSR. el CSR viejo ya esta
+// ordenado, asi que se mezclan nodo por nodo en una pasada y las repetidas se juntan sumando su peso
+void mezclarAristas(Grafo& grafo, const vector<pair<unsigned long long, int>>& nuevas) {
     int n = grafo.numNodos;
-    // usamos dos arrays para guardar el PR nuevo y el anterior en cada iteracion
-    double* nuevo = new double[n];
-    double* anterior = new double[n];
-    const double epsilon = 1e-6; // un valor chico para ver si ya convergio
+    int viejos = static_cast<int>(grafo.inicioVecinos.size()) - 1;
+    vector<int> inicio(n + 1, 0);
+    vector<int> vecinos;
+    vector<int> pesos;
+    vecinos.reserve(grafo.vecinos.size() + nuevas.size());
+    pesos.reserve(grafo.vecinos.size() + nuevas.size());
+    size_t p = 0;
+    for (int i = 0; i < n; ++i) {
+        int inicioNodo = static_cast<int>(vecinos.size());
+        int k = i < viejos ? grafo.inicioVecinos[i] : 0;
+        int finViejos = i < viejos ? grafo.inicioVecinos[i + 1] : 0;
+        while (k < finViejos || (p < nuevas.size() && static_cast<int>(nuevas[p].first >> 32) == i)) {
+            bool hayNueva = p < nuevas.size() && static_cast<int>(nuevas[p].first >> 32) == i;
+            int j = hayNueva ? static_cast<int>(nuevas[p].first & 0xFFFFFFFFu) : 0;
+            if (k < finViejos && (!hayNueva || grafo.vecinos[k] <= j)) {
+                agregarVecino(vecinos, pesos, inicioNodo, grafo.vecinos[k], grafo.pesos[k]);
+                k++;
+            } else {
+                agregarVecino(vecinos, pesos, inicioNodo, j, nuevas[p].second);
+                p++;
+            }
+        }
+        inicio[i + 1] = static_cast<int>(vecinos.size());
+        // si gano vecinos lo anotamos para actualizarPageRank
+        if (inicio[i + 1] - inicioNodo != finViejos - (i < viejos ? grafo.inicioVecinos[i] : 0))
+            grafo.nodosCambiados.push_back(i);
+    }
+    grafo.inicioVecinos.swap(inicio);
+    grafo.vecinos.swap(vecinos);
+    grafo.pesos.swap(pesos);
 
-    // empezamos dandole a todos los nodos el mismo puntaje
+    // cada arista no dirigida se cuenta una vez
+    grafo.numAristas = 0;
+    for (int i = 0; i < n; ++i)
+        for (int k = grafo.inicioVecinos[i]; k < grafo.inicioVecinos[i + 1]; ++k)
+            if (i <= grafo.vecinos[k]) grafo.numAristas++;
+
+    // el grado no cambia hasta el proximo congelado, asi que guardamos 1/grado y el pagerank
+    // multiplica en vez de dividir (los nodos sin vecinos quedan en 0, son los colgantes)
+    grafo.inversoGrado.resize(n);
     for (int i = 0; i < n; ++i) {
-        grafo.pageRank[i] = 1.0 / n;
-        anterior[i] = grafo.pageRank[i];
+        int grado = grafo.inicioVecinos[i + 1] - grafo.inicioVecinos[i];
+        grafo.inversoGrado[i] = grado > 0 ? 1.0 / grado : 0.0;
+    }
+}
+
+// juntamos las aristas que ya estaban en el CSR con las pendientes y armamos el CSR de nuevo
+// solo se ordenan las pendientes, despues se mezclan con el CSR viejo
+void congelarGrafo(Grafo& grafo) {
+    int viejos = static_cast<int>(grafo.inicioVecinos.size()) - 1;
+    if (grafo.aristasPendientes.empty() && viejos == grafo.numNodos) return;
+
+    // las pendientes dirigidas, como es no dirigido cada una va en los dos sentidos
+    vector<unsigned long long> dirigidas;
+    dirigidas.reserve(2 * grafo.aristasPendientes.size());
+    for (unsigned long long clave : grafo.aristasPendientes) {
+        int i = static_cast<int>(clave >> 32);
+        int j = static_cast<int>(clave & 0xFFFFFFFFu);
+        dirigidas.push_back(claveArista(i, j));
+        if (i != j) dirigidas.push_back(claveArista(j, i));
+    }
+    vector<unsigned long long>().swap(grafo.aristasPendientes);
+    sort(dirigidas.begin(), dirigidas.end());
+
+    // las repetidas se juntan en una con peso
+    vector<pair<unsigned long long, int>> nuevas;
+    for (unsigned long long clave : dirigidas) {
+        if (!nuevas.empty() && nuevas.back().first == clave) nuevas.back().second++;
+        else nuevas.emplace_back(clave, 1);
+    }
+    mezclarAristas(grafo, nuevas);
+}
+
+// ordena claves de 64 bits por radix (LSD, de a 16 bits): 4 pasadas lineales sobre el buffer
+// en vez de comparar. las pasadas donde todas las claves tienen el mismo digito se saltan
+void ordenarRadix(vector<unsigned long long>& claves) {
+    vector<unsigned long long> auxiliar(claves.size());
+    vector<size_t> cuenta(1 << 16);
+    for (int desplazamiento = 0; desplazamiento < 64; desplazamiento += 16) {
+        fill(cuenta.begin(), cuenta.end(), 0);
+        for (unsigned long long clave : claves) cuenta[(clave >> desplazamiento) & 0xFFFF]++;
+        if (cuenta[claves.empty() ? 0 : (claves[0] >> desplazamiento) & 0xFFFF] == claves.size()) continue;
+        size_t acumulado = 0;
+        for (size_t& c : cuenta) {
+            size_t cuantos = c;
+            c = acumulado;
+            acumulado += cuantos;
+        }
+        for (unsigned long long clave : claves) auxiliar[cuenta[(clave >> desplazamiento) & 0xFFFF]++] = clave;
+        claves.swap(auxiliar);
+    }
+}
+
+// el armado en lote: los pares se ordenan por radix y se juntan en una pasada (cada par distinto
+// una vez, con cuantas veces salio como peso), y recien ahi se buscan los ids en la tabla y se mezcla
+// con el CSR. asi el costo es recorrer buffers seguidos y no buscar nodos por cada par
+void agregarLote(Grafo& grafo, vector<unsigned long long>& pares) {
+    // como es no dirigido, cada par va en los dos sentidos
+    size_t cuantos = pares.size();
+    pares.reserve(2 * cuantos);
+    for (size_t k = 0; k < cuantos; ++k) {
+        int a = static_cast<int>(pares[k] >> 32);
+        int b = static_cast<int>(pares[k] & 0xFFFFFFFFu);
+        if (a != b) pares.push_back(claveArista(b, a));
+    }
+    ordenarRadix(pares);
+
+    // primero los ids a posiciones: como cada par esta en los dos sentidos, todos los nodos salen
+    // como primer id, y como estan ordenados cada uno se busca una sola vez (los nuevos se numeran en orden de id)
+    for (size_t k = 0; k < pares.size(); ++k)
+        if (k == 0 || (pares[k] >> 32) != (pares[k - 1] >> 32)) obtenerIndice(grafo, static_cast<int>(pares[k] >> 32));
+
+    // y despues juntamos las repetidas en una sola arista con peso
+    vector<pair<unsigned long long, int>> nuevas;
+    int origen = 0;
+    bool ordenadas = true;  // si las posiciones siguen el orden de los ids no hace falta reordenar
+    for (size_t k = 0; k < pares.size(); ++k) {
+        if (k > 0 && pares[k] == pares[k - 1]) {
+            nuevas.back().second++;
+            continue;
+        }
+        if (k == 0 || (pares[k] >> 32) != (pares[k - 1] >> 32)) origen = obtenerIndice(grafo, static_cast<int>(pares[k] >> 32));
+        unsigned long long clave = claveArista(origen, obtenerIndice(grafo, static_cast<int>(pares[k] & 0xFFFFFFFFu)));
+        if (!nuevas.empty() && clave < nuevas.back().first) ordenadas = false;
+        nuevas.emplace_back(clave, 1);
     }
+    vector<unsigned long long>().swap(pares);
+    if (!ordenadas) sort(nuevas.begin(), nuevas.end());
+    mezclarAristas(grafo, nuevas);
+}
+
+// las iteraciones del pagerank, partiendo de lo que haya en grafo.pageRank (tiene que sumar 1)
+// cada iteracion es O(nodos + aristas): primero cada nodo calcula cuanto le da a cada vecino
+// (damping * PR / grado) y despues cada nodo suma lo que le dan sus vecinos (pull).
+// los nodos sin vecinos (colgantes) reparten su PR entre todos, asi la suma sigue dando 1
+int iterarPageRank(Grafo& grafo, int maxIter, double damping) {
+    int n = grafo.numNodos;
+    const double epsilon = 1e-6; // un valor chico para ver si ya convergio
+
+    // dos buffers que se van turnando (el PR actual y el nuevo), se piden una sola vez
+    grafo.residuo.clear(); // lo que quedaba de actualizarPageRank ya no sirve
+    grafo.nodosCambiados.clear(); // y los cambios ya quedan incluidos
+    grafo.siguientePR.resize(n);
+    grafo.contribucion.resize(n);
+    double* actual = grafo.pageRank.data();
+    double* nuevo = grafo.siguientePR.data();
+    double* contribucion = grafo.contribucion.data();
+    const int* inicio = grafo.inicioVecinos.data();
+    const int* vecinos = grafo.vecinos.data();
+    const double* inversoGrado = grafo.inversoGrado.data();
 
     int iter;
     // el bucle principal, itera hasta un maximo o hasta que converja
     for (iter = 1; iter <= maxIter; ++iter) {
-        // calculamos el nuevo PR para cada nodo i
-        for (int i = 0; i < n; ++i) {
-            // esta es la parte base del algoritmo el (1-d)/N
-            nuevo[i] = (1.0 - damping) / n;
-
-            // ahora sumamos la contribucion de los otros nodos j que apuntan a i
-            for (int j = 0; j < n; ++j) {
-                // si j apunta a i...
-                if (grafo.adyacencia[j][i]) {
-                    // necesitamos saber cuantas flechas salen de j (su grado)
-                    int grado = 0;
-                    for (int k = 0; k < n; ++k)
-                        if (grafo.adyacencia[j][k]) grado++;
-
-                    // si tiene grado, sumamos su contribucion (PR de j / grado de j)
-                    if (grado > 0)
-                        nuevo[i] += damping * grafo.pageRank[j] / grado;
-                }
-            }
+        // lo que cada nodo le pasa a cada vecino, y el PR de los colgantes
+        double colgantes = 0.0;
+        for (int j = 0; j < n; ++j) {
+            contribucion[j] = damping * actual[j] * inversoGrado[j];
+            if (inicio[j + 1] == inicio[j]) colgantes += actual[j];
         }
+        // la parte base (1-d)/N mas lo de los colgantes repartido entre todos
+        double base = (1.0 - damping) / n + damping * colgantes / n;
 
-        // despues de calcular todos los nuevos puntajes vemos cuanto cambiaron
+        // calculamos el nuevo PR de cada nodo i sumando a sus vecinos (como es no dirigido,
+        // son los que apuntan a i) y de paso vemos cuanto cambio
         double delta = 0.0;
         for (int i = 0; i < n; ++i) {
-            delta += fabs(nuevo[i] - anterior[i]);
-            anterior[i] = nuevo[i]; // guardamos los nuevos valores para la proxima iteracion
+            double suma = base;
+            for (int k = inicio[i]; k < inicio[i + 1]; ++k)
+                suma += contribucion[vecinos[k]];
+            nuevo[i] = suma;
+            delta += fabs(suma - actual[i]);
         }
 
-        // actualiza el PR oficial con los nuevos valores
-        for (int i = 0; i < n; ++i)
-            grafo.pageRank[i] = nuevo[i];
+        // el nuevo pasa a ser el actual, sin copiar
+        swap(actual, nuevo);
 
         // si el cambio es muy chico (menor a epsilon), paramos el bucle. ya convergio!
         if (delta < epsilon) break;
     }
 
-    // liberamos la memoria que usamos para los calculos
-    delete[] nuevo;
-    delete[] anterior;
+    // el PR oficial tiene que quedar en grafo.pageRank
+    if (actual != grafo.pageRank.data()) grafo.pageRank.swap(grafo.siguientePR);
+
     // devolvemos en cuantas iteraciones termino
     return iter;
 }
 
-// liberar toda la memoria que pedimos con new para no tener leaks
+// la funcion principal para calcular el pagerank, desde cero
+int calcularPageRank(Grafo& grafo, int maxIter, double damping) {
+    congelarGrafo(grafo);
+    // empezamos dandole a todos los nodos el mismo puntaje
+    grafo.pageRank.assign(grafo.numNodos, 1.0 / grafo.numNodos);
+    return iterarPageRank(grafo, maxIter, damping);
+}
+
+// para que los hilos se esperen entre fase y fase (nadie sigue hasta que llegan todos)
+struct Barrera {
+    mutex candado;
+    condition_variable aviso;
+    int hilos;          // cuantos hilos tienen que llegar
+    int esperando;      // cuantos llegaron en esta vuelta
+    int generacion;     // cambia cada vez que se abre, asi se sabe que vuelta es
+};
+
+void esperarBarrera(Barrera& barrera) {
+    unique_lock<mutex> lock(barrera.candado);
+    int generacion = barrera.generacion;
+    if (++barrera.esperando == barrera.hilos) {
+        // el ultimo en llegar abre la barrera para todos
+        barrera.esperando = 0;
+        barrera.generacion++;
+        barrera.aviso.notify_all();
+    } else {
+        barrera.aviso.wait(lock, [&] { return barrera.generacion != generacion; });
+    }
+}
+
+// las sumas parciales de cada hilo, cada una en su propia linea de cache
+// para que los hilos no se pisen la linea al escribir
+struct alignas(64) ParcialPageRank {
+    double colgantes;
+    double delta;
+};
+
+int calcularPageRankParalelo(Grafo& grafo, int maxIter, double damping, int numHilos) {
+    congelarGrafo(grafo);
+    int n = grafo.numNodos;
+    if (numHilos <= 1 || n < numHilos) return calcularPageRank(grafo, maxIter, damping);
+    const double epsilon = 1e-6;
+
+    grafo.pageRank.assign(n, 1.0 / n);
+    grafo.residuo.clear();
+    grafo.nodosCambiados.clear();
+    grafo.siguientePR.resize(n);
+    grafo.contribucion.resize(n);
+    double* contribucion = grafo.contribucion.data();
+    const int* inicio = grafo.inicioVecinos.data();
+    const int* vecinos = grafo.vecinos.data();
+    const double* inversoGrado = grafo.inversoGrado.data();
+
+    // partimos los nodos en rangos seguidos con mas o menos el mismo trabajo (nodos + aristas),
+    // asi un nodo con muchos vecinos no deja a un hilo con todo
+    vector<int> cortes(numHilos + 1, n);
+    cortes[0] = 0;
+    long long trabajo = static_cast<long long>(n) + inicio[n];
+    int i = 0;
+    for (int h = 1; h < numHilos; ++h) {
+        long long objetivo = trabajo * h / numHilos;
+        while (i < n && static_cast<long long>(inicio[i]) + i < objetivo) i++;
+        cortes[h] = i;
+    }
+
+    vector<ParcialPageRank> parciales(numHilos);
+    Barrera barrera;
+    barrera.hilos = numHilos;
+    barrera.esperando = 0;
+    barrera.generacion = 0;
+    int iteraciones = maxIter + 1;      // como en calcularPageRank si no converge
+    double* final = grafo.pageRank.data();
+
+    // lo que hace cada hilo: las mismas dos fases que calcularPageRank pero en su rango
+    // todos suman las parciales en el mismo orden, asi todos deciden lo mismo sobre parar
+    auto trabajar = [&](int h) {
+        double* actual = grafo.pageRank.data();
+        double* nuevo = grafo.siguientePR.data();
+        int desde = cortes[h], hasta = cortes[h + 1];
+        for (int iter = 1; iter <= maxIter; ++iter) {
+            // fase 1: lo que le pasa cada nodo de mi rango a sus vecinos
+            double colgantes = 0.0;
+            for (int j = desde; j < hasta; ++j) {
+                contribucion[j] = damping * actual[j] * inversoGrado[j];
+                if (inicio[j + 1] == inicio[j]) colgantes += actual[j];
+            }
+            parciales[h].colgantes = colgantes;
+            esperarBarrera(barrera);
+
+            // fase 2: el PR nuevo de mi rango, leyendo las contribuciones de todos
+            colgantes = 0.0;
+            for (int k = 0; k < numHilos; ++k) colgantes += parciales[k].colgantes;
+            double base = (1.0 - damping) / n + damping * colgantes / n;
+            double delta = 0.0;
+            for (int v = desde; v < hasta; ++v) {
+                double suma = base;
+                for (int k = inicio[v]; k < inicio[v + 1]; ++k)
+                    suma += contribucion[vecinos[k]];
+                nuevo[v] = suma;
+                delta += fabs(suma - actual[v]);
+            }
+            parciales[h].delta = delta;
+            esperarBarrera(barrera);
+
+            // el delta total (reduccion de las parciales) y cambiamos los buffers
+            delta = 0.0;
+            for (int k = 0; k < numHilos; ++k) delta += parciales[k].delta;
+            swap(actual, nuevo);
+            if (h == 0) final = actual;
+            if (delta < epsilon) {
+                if (h == 0) iteraciones = iter;
+                return;
+            }
+        }
+    };
+
+    // el hilo que llama tambien trabaja, se encarga del primer rango
+    vector<thread> hilos;
+    for (int h = 1; h < numHilos; ++h) hilos.emplace_back(trabajar, h);
+    trabajar(0);
+    for (thread& hilo : hilos) hilo.join();
+
+    // el PR oficial tiene que quedar en grafo.pageRank
+    if (final != grafo.pageRank.data()) grafo.pageRank.swap(grafo.siguientePR);
+    return iteraciones;
+}
+
+// la version incremental usa el pagerank escalado x = n * PR, que cumple
+// x[v] = (1-d) + d * suma de x[u] / grado(u) de sus vecinos u.
+// escalado, agregar un nodo no cambia la ecuacion de los demas (en el normal cambia el (1-d)/n de todos),
+// asi que solo hay que arreglar los nodos que tocaron las aristas nuevas.
+// no hay nodos colgantes: agregarArista siempre le da un vecino a los dos extremos
+int actualizarPageRank(Grafo& grafo, int maxIter, double damping) {
+    // si no hay pagerank anterior no hay de donde partir
+    int nAnterior = static_cast<int>(grafo.pageRank.size());
+    if (nAnterior == 0) {
+        calcularPageRank(grafo, maxIter, damping);
+        return 0;
+    }
+    congelarGrafo(grafo);
+    if (grafo.nodosCambiados.empty()) return 0;
+
+    int n = grafo.numNodos;
+    const int* inicio = grafo.inicioVecinos.data();
+    const int* vecinos = grafo.vecinos.data();
+    const double* inversoGrado = grafo.inversoGrado.data();
+
+    // partimos del pagerank anterior (escalado). los nodos nuevos empiezan con lo del salto al azar
+    vector<double>& x = grafo.pageRank;
+    for (int i = 0; i < nAnterior; ++i) x[i] *= nAnterior;
+    x.resize(n, 1.0 - damping);
+    grafo.residuo.resize(n, 0.0);
+    grafo.enCola.resize(n, 0); // siempre queda en 0 al terminar
+    double* residuo = grafo.residuo.data();
+
+    // a quien hay que recalcularle el residuo: los nodos que ganaron vecinos desde el ultimo
+    // pagerank (o que son nuevos) y todos sus vecinos, porque lo que les pasa ese nodo cambio
+    vector<int> cola;
+    auto marcar = [&](int v) {
+        if (!grafo.enCola[v]) { grafo.enCola[v] = 1; cola.push_back(v); }
+    };
+    for (int v : grafo.nodosCambiados) {
+        marcar(v);
+        for (int k = inicio[v]; k < inicio[v + 1]; ++k) marcar(vecinos[k]);
+    }
+    grafo.nodosCambiados.clear();
+    long long volumen = 0; // lo que costo recalcular: los nodos tocados y sus vecinos
+    for (int v : cola) {
+        double suma = 1.0 - damping;
+        for (int k = inicio[v]; k < inicio[v + 1]; ++k)
+            suma += damping * x[vecinos[k]] * inversoGrado[vecinos[k]];
+        residuo[v] = suma - x[v];
+        grafo.enCola[v] = 0;
+        volumen += 1 + inicio[v + 1] - inicio[v];
+    }
+
+    // se empuja hasta EMPUJES_POR_CAMBIO veces lo que costo recalcular, asi el trabajo depende del
+    // tamaño del lote y no del grafo. si no alcanza es que el cambio se desparramo por todo el grafo,
+    // y se sigue con iteraciones normales. como empujar salta por la memoria (una iteracion la recorre
+    // en orden), nunca se empuja mas que un cuarto de las aristas, asi rendirse no sale caro
+    long long presupuesto = min<long long>(EMPUJES_POR_CAMBIO * volumen, inicio[n] / 4);
+
+    // un nodo se empuja si su residuo pasa RESIDUO_RELATIVO * x[v]. al terminar ningun nodo supera
+    // eso, asi que el residuo total es a lo mas RESIDUO_RELATIVO * n y el error de x (en la escala normal)
+    // a lo mas RESIDUO_RELATIVO / (1 - d), sin importar el tamaño del grafo ni cuantas veces se llame
+    // (el residuo que queda se guarda para la proxima). como x[v] >= 1 - d el umbral nunca se achica a 0,
+    // y los nodos que importan poco dejan de empujar antes, asi el cambio no se desparrama por todo el grafo
+    auto superaUmbral = [&](int v) { return fabs(residuo[v]) > RESIDUO_RELATIVO * x[v]; };
+    bool alcanzo = true;
+
+    // empujamos: el nodo se queda con su residuo y le pasa d * residuo / grado a cada vecino.
+    // la cola solo tiene nodos con residuo mas grande que su umbral
+    vector<int> pendientes;
+    for (int v : cola)
+        if (superaUmbral(v)) { grafo.enCola[v] = 1; pendientes.push_back(v); }
+    long long gastado = 0;
+    size_t q = 0;
+    for (; q < pendientes.size() && alcanzo; ++q) {
+        int v = pendientes[q];
+        grafo.enCola[v] = 0;
+        double r = residuo[v];
+        residuo[v] = 0.0;
+        x[v] += r;
+        gastado += 1 + inicio[v + 1] - inicio[v];
+        if (gastado > presupuesto) alcanzo = false;
+        double paso = damping * r * inversoGrado[v];
+        for (int k = inicio[v]; k < inicio[v + 1]; ++k) {
+            int u = vecinos[k];
+            residuo[u] += paso;
+            if (!grafo.enCola[u] && superaUmbral(u)) {
+                grafo.enCola[u] = 1;
+                pendientes.push_back(u);
+            }
+        }
+    }
+
+    // y volvemos a la escala normal (que sume 1)
+    if (alcanzo) {
+        for (int i = 0; i < n; ++i) x[i] /= n;
+        return 0;
+    }
+
+    // no alcanzo el presupuesto: iteraciones normales partiendo del pagerank que ya tenemos.
+    // lo que quedo en los residuos falta en x, asi que lo normalizamos para que sume 1 justo
+    // (si no, las iteraciones tardan en corregir la suma, que solo baja de a damping por vuelta)
+    for (; q < pendientes.size(); ++q) grafo.enCola[pendientes[q]] = 0;
+    double suma = 0.0;
+    for (int i = 0; i < n; ++i) suma += x[i];
+    for (int i = 0; i < n; ++i) x[i] /= suma;
+    return iterarPageRank(grafo, maxIter, damping);
+}
+
+// liberar toda la memoria que pedimos para no tener leaks
 void liberarGrafo(Grafo& grafo) {
-    // primero liberamos cada fila de la matriz
-    for (int i = 0; i < grafo.numNodos; ++i)
-        delete[] grafo.adyacencia[i];
-    // despues el array de punteros
-    delete[] grafo.adyacencia;
-    
-    // y los otros dos arrays
-    delete[] grafo.ids;
-    delete[] grafo.pageRank;
+    // swap con vectores vacios para devolver la memoria de verdad (clear no la devuelve)
+    vector<int>().swap(grafo.ids);
+    vector<double>().swap(grafo.pageRank);
+    vector<int>().swap(grafo.tablaIds);
+    vector<unsigned long long>().swap(grafo.aristasPendientes);
+    vector<int>().swap(grafo.inicioVecinos);
+    vector<int>().swap(grafo.vecinos);
+    vector<int>().swap(grafo.pesos);
+    vector<double>().swap(grafo.inversoGrado);
+    vector<double>().swap(grafo.contribucion);
+    vector<double>().swap(grafo.siguientePR);
+    vector<double>().swap(grafo.residuo);
+    vector<char>().swap(grafo.enCola);
+    vector<int>().swap(grafo.nodosCambiados);
+    grafo.numNodos = 0;
+    grafo.numAristas = 0;
+}
+
+// pide la memoria de la tabla alineada a 64 bytes (una linea de cache), asi un doc nunca queda
+// partido entre dos lineas y los vecinos de id caen en la misma
+void pedirTablaPageRank(TablaPageRank& tabla, int numDocs, int bits) {
+    tabla.numDocs = numDocs;
+    tabla.bytesPorDoc = bits == 16 ? 2 : (bits == 32 ? 4 : 8);
+    tabla.escala = 1.0;
+    size_t bytes = (bytesTablaPageRank(tabla) + 63) & ~static_cast<size_t>(63); // aligned_alloc pide multiplo
+    tabla.memoria = aligned_alloc(64, bytes);
+    if (tabla.memoria == nullptr) throw bad_alloc(); // como cuando no alcanza para un vector
+    tabla.datos = tabla.memoria;
+}
+
+void armarTablaPageRank(const vector<double>& pageRankPorDoc, int bits, TablaPageRank& tabla) {
+    int numDocs = pageRankPorDoc.empty() ? 0 : static_cast<int>(pageRankPorDoc.size()) - 1;
+    pedirTablaPageRank(tabla, numDocs, bits);
+    if (tabla.bytesPorDoc == 8) {
+        double* valores = static_cast<double*>(tabla.memoria);
+        for (int id = 0; id <= numDocs; ++id) valores[id] = pageRankPorDoc[id] < 0 ? SIN_PAGERANK : pageRankPorDoc[id];
+    } else if (tabla.bytesPorDoc == 4) {
+        float* valores = static_cast<float*>(tabla.memoria);
+        for (int id = 0; id <= numDocs; ++id)
+            valores[id] = static_cast<float>(pageRankPorDoc[id] < 0 ? SIN_PAGERANK : pageRankPorDoc[id]);
+    } else {
+        // 16 bits: de 0 al maximo en 65535 pasos iguales (el ultimo es el valor especial),
+        // asi el error de cada doc es a lo mas media escala y el orden entre docs se mantiene
+        double maximo = 0.0;
+        for (double pr : pageRankPorDoc) maximo = max(maximo, pr);
+        tabla.escala = maximo > 0 ? maximo / (SIN_PAGERANK_16 - 1) : 1.0;
+        unsigned short* valores = static_cast<unsigned short*>(tabla.memoria);
+        for (int id = 0; id <= numDocs; ++id) {
+            valores[id] = pageRankPorDoc[id] < 0 ? SIN_PAGERANK_16
+                        : static_cast<unsigned short>(min<long>(lround(pageRankPorDoc[id] / tabla.escala), SIN_PAGERANK_16 - 1));
+        }
+    }
+}
+
+void armarTablaPageRank(const Grafo& grafo, int numDocs, int bits, TablaPageRank& tabla) {
+    vector<double> pageRankPorDoc(numDocs + 1, SIN_PAGERANK);
+    for (int i = 0; i < grafo.numNodos && i < static_cast<int>(grafo.pageRank.size()); ++i)
+        if (grafo.ids[i] >= 0 && grafo.ids[i] <= numDocs) pageRankPorDoc[grafo.ids[i]] = grafo.pageRank[i];
+    armarTablaPageRank(pageRankPorDoc, bits, tabla);
+}
+
+void vistaTablaPageRank(const void* datos, int numDocs, int bytesPorDoc, double escala, TablaPageRank& tabla) {
+    tabla.numDocs = numDocs;
+    tabla.bytesPorDoc = bytesPorDoc;
+    tabla.escala = escala;
+    tabla.datos = datos;
+    tabla.memoria = nullptr;
+}
+
+void renumerarTablaPageRank(TablaPageRank& tabla, const vector<int>& nuevoId) {
+    TablaPageRank nueva;
+    pedirTablaPageRank(nueva, tabla.numDocs, tabla.bytesPorDoc * 8);
+    nueva.escala = tabla.escala;
+    const char* antes = static_cast<const char*>(tabla.datos);
+    char* despues = static_cast<char*>(nueva.memoria);
+    memcpy(despues, antes, tabla.bytesPorDoc); // la posicion 0 no es un doc
+    for (int id = 1; id <= tabla.numDocs; ++id)
+        memcpy(despues + static_cast<size_t>(nuevoId[id]) * tabla.bytesPorDoc,
+               antes + static_cast<size_t>(id) * tabla.bytesPorDoc, tabla.bytesPorDoc);
+    liberarTablaPageRank(tabla);
+    tabla = nueva;
+}
+
+double pageRankTabla(const TablaPageRank& tabla, int idDoc) {
+    if (idDoc < 0 || idDoc > tabla.numDocs) return 0.0;
+    if (tabla.bytesPorDoc == 8) {
+        double pr = static_cast<const double*>(tabla.datos)[idDoc];
+        return pr < 0 ? 0.0 : pr;
+    }
+    if (tabla.bytesPorDoc == 4) {
+        float pr = static_cast<const float*>(tabla.datos)[idDoc];
+        return pr < 0 ? 0.0 : pr;
+    }
+    unsigned short valor = static_cast<const unsigned short*>(tabla.datos)[idDoc];
+    return valor == SIN_PAGERANK_16 ? 0.0 : valor * tabla.escala;
+}
+
+bool docEnGrafo(const TablaPageRank& tabla, int idDoc) {
+    if (idDoc < 0 || idDoc > tabla.numDocs) return false;
+    if (tabla.bytesPorDoc == 8) return static_cast<const double*>(tabla.datos)[idDoc] >= 0;
+    if (tabla.bytesPorDoc == 4) return static_cast<const float*>(tabla.datos)[idDoc] >= 0;
+    return static_cast<const unsigned short*>(tabla.datos)[idDoc] != SIN_PAGERANK_16;
+}
+
+size_t bytesTablaPageRank(const TablaPageRank& tabla) {
+    return static_cast<size_t>(tabla.numDocs + 1) * tabla.bytesPorDoc;
+}
+
+void liberarTablaPageRank(TablaPageRank& tabla) {
+    free(tabla.memoria);
+    tabla.memoria = nullptr;
+    tabla.datos = nullptr;
+    tabla.numDocs = 0;
 }
@@ -1,29 +1,104 @@
 #ifndef GRAFO_H
 #define GRAFO_H
 
+#include <vector>
+#include <cstddef>
+
 // para que no se incluya dos veces y de error de compilacion
 
 // La estructura principal del grafo, aqui guardamos todo
+// las aristas se van juntando en una lista y despues se congelan en formato CSR
+// (para cada nodo, donde empiezan sus vecinos en un solo array), asi la memoria
+// depende de cuantas aristas hay y no de nodos al cuadrado como con la matriz
 struct Grafo {
-    int numNodos;           // cuantos nodos tenemos ahora mismo
-    int* ids;               // el array que guarda los IDs de los docs
-    double* pageRank;       // el array para los puntajes de pagerank
-    int** adyacencia;       // la matriz para ver que nodo se conecta con que nodo
-    int numAristas;         // para contar cuantas aristas hay en el grafo
+    int numNodos;                           // cuantos nodos tenemos ahora mismo
+    int numAristas;                         // aristas distintas (no dirigidas), se cuenta al congelar
+    std::vector<int> ids;                   // el array que guarda los IDs de los docs (posicion -> id)
+    std::vector<double> pageRank;           // el array para los puntajes de pagerank
+    std::vector<int> tablaIds;              // tabla hash id -> posicion + 1 (0 = vacio), potencia de 2
+    std::vector<unsigned long long> aristasPendientes; // (i << 32 | j) que todavia no estan en el CSR
+    std::vector<int> inicioVecinos;         // numNodos + 1: los vecinos de i van de inicioVecinos[i] a inicioVecinos[i+1]
+    std::vector<int> vecinos;               // las posiciones de los vecinos, ordenadas dentro de cada nodo
+    std::vector<int> pesos;                 // cuantas veces se agrego cada arista (una por vecino)
+    std::vector<double> inversoGrado;       // 1 / grado de cada nodo (0 si no tiene vecinos), se arma al congelar
+    std::vector<double> contribucion;       // buffers del pagerank, se reusan entre llamadas
+    std::vector<double> siguientePR;
+    std::vector<double> residuo;            // para actualizarPageRank: lo que le falta a cada nodo (escalado por n)
+    std::vector<char> enCola;               // para no meter dos veces el mismo nodo en la cola
+    std::vector<int> nodosCambiados;        // los que ganaron vecinos desde el ultimo pagerank
 };
 
 
 
-// para preparar el grafo
-void inicializarGrafo(Grafo& grafo, int maxNodos);
+// el pagerank de cada documento en un array denso indexado por id de doc, para no buscar el doc
+// en el grafo cada vez. se arma una vez despues de calcularPageRank y ya no cambia. cada valor
+// puede ir en double, float o 16 bits (cuantizado con una escala: con muchos docs ocupa la cuarta
+// parte). los docs que nunca salieron en el log tienen un valor especial y valen 0
+struct TablaPageRank {
+    int numDocs;                            // ids de 0 a numDocs
+    int bytesPorDoc;                        // 8 (double), 4 (float) o 2 (16 bits)
+    double escala;                          // con 16 bits: pagerank = valor * escala
+    const void* datos;                      // numDocs + 1 valores
+    void* memoria;                          // lo que se pidio, alineado a 64 bytes (nullptr si datos es de otro)
+};
+
+// los valores especiales para "no esta en el grafo"
+const double SIN_PAGERANK = -1.0;           // en double y en float
+const unsigned short SIN_PAGERANK_16 = 0xFFFF;
 
-// para conectar dos nodos
+// para preparar el grafo (vacio, sin limite de nodos)
+void inicializarGrafo(Grafo& grafo);
+
+// para conectar dos nodos (queda pendiente hasta congelarGrafo)
 void agregarArista(Grafo& grafo, int id1, int id2);
 
-// la funcion del pagerank devuelve las iteraciones que tomo
+// mete las aristas pendientes en el CSR (se puede llamar varias veces)
+void congelarGrafo(Grafo& grafo);
+
+// la clave de un par (id1 << 32 | id2), para llenar los lotes
+unsigned long long claveArista(int id1, int id2);
+
+// para armar el grafo de una vez con muchos pares de documentos (claveArista(id1, id2)), por ejemplo
+// todos los del log de consultas. los pares repetidos quedan como una arista con peso.
+// deja el lote vacio y el grafo congelado
+void agregarLote(Grafo& grafo, std::vector<unsigned long long>& pares);
+
+// la funcion del pagerank devuelve las iteraciones que tomo (congela el grafo si hace falta)
 int calcularPageRank(Grafo& grafo, int maxIter, double damping);
 
+// lo mismo repartiendo los nodos entre varios hilos (con 1 hilo es calcularPageRank)
+// cada hilo calcula el PR nuevo de un rango de nodos leyendo a sus vecinos (pull), asi nadie
+// escribe donde escribe otro. cada nodo suma a sus vecinos en el mismo orden, pero la masa de los
+// colgantes y el delta se suman por hilo y despues se juntan, asi que da igual que con 1 hilo salvo
+// redondeo (y puede parar una iteracion antes o despues). con la misma cantidad de hilos da siempre lo mismo
+int calcularPageRankParalelo(Grafo& grafo, int maxIter, double damping, int numHilos);
+
+// despues de agregar un lote de aristas, actualiza el pagerank partiendo del que ya estaba
+// en vez de calcularlo de cero. solo se recalculan los nodos de las aristas nuevas y sus vecinos,
+// y desde ahi se va empujando la diferencia (residuo) a los vecinos hasta que a ningun nodo le falte
+// mas de una parte en 10^5 de su pagerank. el trabajo de empujar tiene un tope proporcional al lote;
+// si el cambio no entra en eso se sigue iterando normal desde el pagerank anterior (que igual converge
+// antes que desde cero). congela el grafo, que es O(aristas) si hay pendientes.
+// devuelve cuantas iteraciones completas hicieron falta (0 si alcanzo con empujar)
+int actualizarPageRank(Grafo& grafo, int maxIter, double damping);
+
 // para borrar todo al final y que no queden memory leaks
 void liberarGrafo(Grafo& grafo);
 
+// arma la tabla densa con el pagerank de los nodos que son docs de 1 a numDocs. bits es 64, 32 o 16
+void armarTablaPageRank(const Grafo& grafo, int numDocs, int bits, TablaPageRank& tabla);
+// lo mismo a partir de un pagerank por doc ya armado (los negativos son docs que no estan en el grafo)
+void armarTablaPageRank(const std::vector<double>& pageRankPorDoc, int bits, TablaPageRank& tabla);
+// una tabla que apunta a valores que guarda otro (por ejemplo el segmento), sin copiarlos
+void vistaTablaPageRank(const void* datos, int numDocs, int bytesPorDoc, double escala, TablaPageRank& tabla);
+// le cambia el id a cada doc (nuevoId[id]), como renumerarIndice
+void renumerarTablaPageRank(TablaPageRank& tabla, const std::vector<int>& nuevoId);
+// el pagerank de un doc (0 si no esta en el grafo o el id no esta en la tabla)
+double pageRankTabla(const TablaPageRank& tabla, int idDoc);
+// si el doc salio en el log (esta en el grafo)
+bool docEnGrafo(const TablaPageRank& tabla, int idDoc);
+// cuantos bytes ocupan los valores
+size_t bytesTablaPageRank(const TablaPageRank& tabla);
+void liberarTablaPageRank(TablaPageRank& tabla);
+
 #endif // GRAFO_H
@@ -1,70 +1,414 @@
 #include "index.h"
+#include "utils.h"
+#include "documentos.h"
 #include <iostream>
+#include <thread>
 #include <vector>
 #include <algorithm>
 
+// capacidad inicial de la tabla de terminos, tiene que ser potencia de 2
+const int CAPACIDAD_INICIAL_TABLA = 1024;
+
 // para dejar el indice vacio al principio
 void inicializarIndice(IndiceInvertido& indice) {
     indice.inicio = nullptr;
+    indice.numTerminos = 0;
+    indice.numDocs = 0;
+    indice.largoDocumentos.clear();
+    indice.idsOriginales.clear();
+    indice.tabla.assign(CAPACIDAD_INICIAL_TABLA, nullptr);
+}
+
+// hash FNV-1a de 32 bits, es simple y reparte bien las palabras cortas
+unsigned int hashTermino(std::string_view termino) {
+    unsigned int hash = 2166136261u;
+    for (char c : termino) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// devuelve la posicion de la tabla donde esta el termino, o la primera vacia si no esta
+// como la capacidad es potencia de 2 usamos & en vez de % para el modulo
+size_t buscarPosicion(const IndiceInvertido& indice, std::string_view termino, unsigned int hash) {
+    size_t mascara = indice.tabla.size() - 1;
+    size_t pos = hash & mascara;
+    while (indice.tabla[pos] != nullptr) {
+        NodoTermino* nodo = indice.tabla[pos];
+        // comparamos primero el hash guardado, que es mas barato que comparar strings
+        if (nodo->hash == hash && nodo->termino == termino) return pos;
+        pos = (pos + 1) & mascara; // sondeo lineal, probamos la siguiente
+    }
+    return pos;
+}
+
+// cuando la tabla se llena mucho la duplicamos y volvemos a meter todos los terminos
+void agrandarTabla(IndiceInvertido& indice) {
+    std::vector<NodoTermino*> nueva(indice.tabla.size() * 2, nullptr);
+    size_t mascara = nueva.size() - 1;
+    for (NodoTermino* nodo = indice.inicio; nodo != nullptr; nodo = nodo->siguiente) {
+        size_t pos = nodo->hash & mascara;
+        while (nueva[pos] != nullptr) pos = (pos + 1) & mascara;
+        nueva[pos] = nodo;
+    }
+    indice.tabla.swap(nueva);
+}
+
+// escribe un numero en VByte: 7 bits por byte, el bit alto prendido quiere decir que sigue otro byte
+void escribirVByte(std::vector<unsigned char>& datos, unsigned int valor) {
+    while (valor >= 128) {
+        datos.push_back(static_cast<unsigned char>((valor & 127) | 128));
+        valor >>= 7;
+    }
+    datos.push_back(static_cast<unsigned char>(valor));
+}
+
+// lee un numero en VByte y deja el puntero justo despues
+unsigned int leerVByte(const unsigned char*& p) {
+    unsigned int valor = *p & 127;
+    int corrimiento = 7;
+    while (*p++ & 128) {
+        valor |= static_cast<unsigned int>(*p & 127) << corrimiento;
+        corrimiento += 7;
+    }
+    return valor;
+}
+
+// comprime el bloque pendiente y lo agrega al final de los datos, con su entrada de salto
+void comprimirPendientes(ConstructorPostings& lista) {
+    if (lista.idsPendientes.empty()) return;
+    const std::vector<int>& ids = lista.idsPendientes;
+    SaltoBloque salto;
+    salto.primerId = ids.front();
+    salto.ultimoId = ids.back();
+    salto.offset = static_cast<unsigned int>(lista.datos.size());
+    lista.saltos.push_back(salto);
+
+    // el primer id ya esta en el salto, guardamos solo las diferencias con el anterior
+    for (size_t i = 1; i < ids.size(); ++i)
+        escribirVByte(lista.datos, static_cast<unsigned int>(ids[i] - ids[i - 1]));
+    for (int frecuencia : lista.frecPendientes)
+        escribirVByte(lista.datos, static_cast<unsigned int>(frecuencia));
+
+    lista.idsPendientes.clear();
+    lista.frecPendientes.clear();
+}
+
+// la vista de solo lectura de lo que esta comprimido
+ListaPostings vistaPostings(const ConstructorPostings& lista) {
+    ListaPostings vista;
+    vista.numDocs = static_cast<int>(lista.numDocs - lista.idsPendientes.size());
+    vista.numBloques = static_cast<int>(lista.saltos.size());
+    vista.saltos = lista.saltos.data();
+    vista.datos = lista.datos.data();
+    vista.termino = -1; // lo pone quien sabe de que termino es
+    vista.maximos = nullptr; // los maximos de BM25 se calculan al armar el segmento
+    vista.maximosPrior = nullptr;
+    vista.maxPuntaje = 0.0f;
+    vista.maxPrior = 0.0f;
+    return vista;
+}
+
+// si la lista ya estaba finalizada, descomprimimos el ultimo bloque para poder seguir agregando
+// (asi todos los bloques quedan llenos menos el ultimo)
+void reabrirUltimoBloque(ConstructorPostings& lista) {
+    if (!lista.idsPendientes.empty() || lista.saltos.empty()) return;
+    int ultimo = static_cast<int>(lista.saltos.size()) - 1;
+    int cuantos = lista.numDocs - ultimo * TAM_BLOQUE;
+    if (cuantos >= TAM_BLOQUE) return; // estaba lleno, el proximo doc empieza un bloque nuevo
+    ListaPostings vista = vistaPostings(lista); // la vista antes de tocar los pendientes
+    lista.idsPendientes.resize(cuantos);
+    lista.frecPendientes.resize(cuantos);
+    decodificarBloque(vista, ultimo, lista.idsPendientes.data(), lista.frecPendientes.data());
+    lista.datos.resize(lista.saltos[ultimo].offset);
+    lista.saltos.pop_back();
+}
+
+// vuelve a comprimir la lista entera a partir de ids (ordenados) y sus frecuencias
+void rearmarLista(ConstructorPostings& lista, const std::vector<int>& ids, const std::vector<int>& frecuencias) {
+    lista.saltos.clear();
+    lista.datos.clear();
+    lista.idsPendientes.clear();
+    lista.frecPendientes.clear();
+    lista.numDocs = 0;
+    for (size_t i = 0; i < ids.size(); ++i) {
+        if (static_cast<int>(lista.idsPendientes.size()) == TAM_BLOQUE) comprimirPendientes(lista);
+        lista.idsPendientes.push_back(ids[i]);
+        lista.frecPendientes.push_back(frecuencias[i]);
+        lista.numDocs++;
+    }
 }
 
 // funcion para meter un documento en la lista de un termino (posting list)
-void insertarDocumento(NodoDoc*& lista, int idDocumento) {
-    // recorre la lista de documentos de ese termino
-    NodoDoc* actual = lista;
-    while (actual != nullptr) {
-        // si ya estaba el doc, solo le suma uno a la frecuencia y listo
-        if (actual->idDocumento == idDocumento) {
-            actual->frecuencia += 1;
-            return;
-        }
-        actual = actual->siguiente;
+// como los documentos llegan en orden creciente de id, solo hace falta mirar el ultimo
+// (frecuencia es cuantas veces sumar, 1 al leer palabra por palabra)
+void insertarDocumento(ConstructorPostings& lista, int idDocumento, int frecuencia) {
+    reabrirUltimoBloque(lista);
+
+    // si el ultimo doc de la lista es este mismo, solo le sumamos a la frecuencia
+    if (!lista.idsPendientes.empty() && lista.idsPendientes.back() == idDocumento) {
+        lista.frecPendientes.back() += frecuencia;
+        return;
+    }
+
+    // lo normal: un doc nuevo mas grande que todos, lo agregamos al final
+    int ultimoId = !lista.idsPendientes.empty() ? lista.idsPendientes.back()
+                 : (!lista.saltos.empty() ? lista.saltos.back().ultimoId : 0);
+    if (lista.numDocs == 0 || ultimoId < idDocumento) {
+        // si el bloque pendiente ya esta lleno lo comprimimos antes
+        if (static_cast<int>(lista.idsPendientes.size()) == TAM_BLOQUE) comprimirPendientes(lista);
+        lista.idsPendientes.push_back(idDocumento);
+        lista.frecPendientes.push_back(frecuencia);
+        lista.numDocs++;
+        return;
     }
 
-    // si no estaba, creamos un nodo nuevo para el doc
-    NodoDoc* nuevo = new NodoDoc;
-    nuevo->idDocumento = idDocumento;
-    nuevo->frecuencia = 1; //la primera vez que aparece, frecuencia 1
-    // y lo ponemos al principio de la lista
-    nuevo->siguiente = lista;
-    lista = nuevo;
+    // por si alguien inserta fuera de orden: descomprimimos todo, lo metemos en su lugar
+    // con busqueda binaria y volvemos a comprimir. es lento pero no pasa al leer el archivo en orden
+    std::vector<int> ids, frecuencias;
+    comprimirPendientes(lista);
+    descomprimirLista(vistaPostings(lista), ids, &frecuencias);
+    size_t pos = std::lower_bound(ids.begin(), ids.end(), idDocumento) - ids.begin();
+    if (pos < ids.size() && ids[pos] == idDocumento) {
+        frecuencias[pos] += frecuencia;
+    } else {
+        ids.insert(ids.begin() + pos, idDocumento);
+        frecuencias.insert(frecuencias.begin() + pos, frecuencia);
+    }
+    rearmarLista(lista, ids, frecuencias);
 }
 
-// aqui insertamos un termino en el indice
-void insertarTermino(IndiceInvertido& indice, const std::string& termino, int idDocumento) {
-    // recorremos la lista principal de terminos para ver si ya existe
-    NodoTermino* actual = indice.inicio;
-    while (actual != nullptr) {
-        // si ya existe el termino
-        if (actual->termino == termino) {
-            // solo llamamos a insertarDocumento para que agregue el doc a su lista
-            insertarDocumento(actual->listaDocumentos, idDocumento);
-            return;
-        }
-        actual = actual->siguiente;
+// descomprime un bloque de una posting list
+int decodificarBloque(const ListaPostings& lista, int bloque, int* ids, int* frecuencias) {
+    // todos los bloques estan llenos menos el ultimo
+    int cuantos = (bloque == lista.numBloques - 1) ? lista.numDocs - bloque * TAM_BLOQUE : TAM_BLOQUE;
+    const unsigned char* p = lista.datos + lista.saltos[bloque].offset;
+    int id = lista.saltos[bloque].primerId;
+    ids[0] = id;
+    for (int i = 1; i < cuantos; ++i) {
+        id += static_cast<int>(leerVByte(p)); // le sumamos la diferencia al anterior
+        ids[i] = id;
     }
+    if (frecuencias) {
+        for (int i = 0; i < cuantos; ++i) frecuencias[i] = static_cast<int>(leerVByte(p));
+    }
+    return cuantos;
+}
+
+// descomprime todos los bloques uno detras de otro
+void descomprimirLista(const ListaPostings& lista, std::vector<int>& ids, std::vector<int>* frecuencias) {
+    ids.resize(lista.numDocs);
+    if (frecuencias) frecuencias->resize(lista.numDocs);
+    for (int b = 0; b < lista.numBloques; ++b) {
+        decodificarBloque(lista, b, ids.data() + b * TAM_BLOQUE,
+                          frecuencias ? frecuencias->data() + b * TAM_BLOQUE : nullptr);
+    }
+}
+
+// al terminar de construir comprimimos lo que quedo pendiente en cada termino,
+// devolvemos la memoria que sobra de los vectores y apuntamos las vistas a los datos
+void finalizarIndice(IndiceInvertido& indice) {
+    for (NodoTermino* actual = indice.inicio; actual != nullptr; actual = actual->siguiente) {
+        ConstructorPostings& lista = actual->postings;
+        comprimirPendientes(lista);
+        lista.datos.shrink_to_fit();
+        lista.saltos.shrink_to_fit();
+        std::vector<int>().swap(lista.idsPendientes);
+        std::vector<int>().swap(lista.frecPendientes);
+        actual->listaDocumentos = vistaPostings(lista);
+    }
+}
+
+// cuantos bytes ocupan las listas comprimidas
+size_t memoriaPostings(const IndiceInvertido& indice) {
+    size_t bytes = 0;
+    for (NodoTermino* actual = indice.inicio; actual != nullptr; actual = actual->siguiente) {
+        bytes += actual->postings.datos.size() + actual->postings.saltos.size() * sizeof(SaltoBloque);
+    }
+    return bytes;
+}
+
+// busca el nodo de un termino y si no existe lo crea (con la lista vacia)
+NodoTermino* obtenerTermino(IndiceInvertido& indice, std::string_view termino, unsigned int hash) {
+    size_t pos = buscarPosicion(indice, termino, hash);
+    if (indice.tabla[pos] != nullptr) return indice.tabla[pos];
 
     // si no existe el termino lo creamos
     NodoTermino* nuevoTermino = new NodoTermino;
     nuevoTermino->termino = termino;
-    nuevoTermino->listaDocumentos = nullptr; // su lista de docs empieza vacia
+    nuevoTermino->postings.numDocs = 0; // su lista de docs empieza vacia
+    nuevoTermino->listaDocumentos = vistaPostings(nuevoTermino->postings);
+    nuevoTermino->hash = hash;
+    nuevoTermino->numero = indice.numTerminos;
     // lo ponemos al principio de la lista de terminos
     nuevoTermino->siguiente = indice.inicio;
     indice.inicio = nuevoTermino;
+    // y en el hueco libre de la tabla
+    indice.tabla[pos] = nuevoTermino;
+    indice.numTerminos++;
+
+    // si la tabla quedo llena mas del 70% la agrandamos, asi las busquedas siguen siendo O(1)
+    if (indice.numTerminos * 10 > static_cast<int>(indice.tabla.size()) * 7) agrandarTabla(indice);
+    return nuevoTermino;
+}
+
+// aqui insertamos un termino en el indice
+void insertarTermino(IndiceInvertido& indice, std::string_view termino, int idDocumento) {
+    // contamos la palabra en el largo del documento (la tabla de documentos)
+    if (idDocumento >= static_cast<int>(indice.largoDocumentos.size()))
+        indice.largoDocumentos.resize(idDocumento + 1, 0);
+    indice.largoDocumentos[idDocumento]++;
+    if (idDocumento > indice.numDocs) indice.numDocs = idDocumento;
 
-    // y le agregamos el documento a su nueva lista
-    insertarDocumento(nuevoTermino->listaDocumentos, idDocumento);
+    // buscamos el termino en la tabla hash (o lo creamos) y le agregamos el doc a su lista
+    NodoTermino* nodo = obtenerTermino(indice, termino, hashTermino(termino));
+    insertarDocumento(nodo->postings, idDocumento, 1);
 }
 
 // una funcion simple para buscar una palabra en el indice
-NodoTermino* buscarTermino(IndiceInvertido& indice, const std::string& termino) {
-    NodoTermino* actual = indice.inicio;
-    while (actual != nullptr) {
-        // si la encontramos devolvemos el puntero al nodo si no, null
-        if (actual->termino == termino) return actual;
-        actual = actual->siguiente;
+NodoTermino* buscarTermino(IndiceInvertido& indice, std::string_view termino) {
+    // si la encontramos devolvemos el puntero al nodo si no, null (el hueco vacio)
+    return indice.tabla[buscarPosicion(indice, termino, hashTermino(termino))];
+}
+
+// indexa las lineas que empiezan entre los bytes inicio y fin del archivo (ya abierto)
+// los ids son locales: la primera linea del rango es el doc 1. devuelve cuantas lineas leyo
+int indexarRango(IndiceInvertido& indice, const ArchivoDocumentos& documentos,
+                 unsigned long long inicio, unsigned long long fin,
+                 const FiltroStopwords& stopwords) {
+    CursorDocumentos cursor;
+    iniciarCursorDocumentos(documentos, inicio, fin, cursor);
+    std::string_view linea, contenido;
+    Tokenizador tokenizador;
+
+    int idDoc = 1;
+    while (siguienteLinea(cursor, linea)) {
+        if (contenidoDocumento(linea, contenido)) {
+            // recorremos el contenido directo sobre el archivo mapeado, sin copiarlo
+            iniciarTokenizador(tokenizador, contenido);
+            std::string_view palabra;
+            // y procesamos palabra por palabra
+            while (siguientePalabra(tokenizador, palabra)) {
+                // si no es stopword, la metemos al indice
+                if (!esStopword(palabra, stopwords))
+                    insertarTermino(indice, palabra, idDoc);
+            }
+        }
+        idDoc++;
+    }
+    // los docs del final pueden no tener palabras, igual cuentan
+    indice.numDocs = idDoc - 1;
+    indice.largoDocumentos.resize(indice.numDocs + 1, 0);
+    return idDoc - 1;
+}
+
+// leemos el archivo de documentos linea por linea y vamos llenando el indice
+int construirIndice(IndiceInvertido& indice, const std::string& archivoDocumentos,
+                    const FiltroStopwords& stopwords) {
+    ArchivoDocumentos documentos;
+    if (!abrirDocumentos(archivoDocumentos, documentos)) {
+        std::cerr << "❌ Error: no se pudo abrir " << archivoDocumentos << "\n";
+        return -1;
     }
-    return nullptr;
+    int numDocs = indexarRango(indice, documentos, 0, documentos.tam, stopwords);
+    cerrarDocumentos(documentos);
+    // comprimimos los bloques que quedaron a medio llenar
+    finalizarIndice(indice);
+    return numDocs;
+}
+
+// agrega al final del indice todas las listas de un indice parcial, corriendo sus ids
+// (el parcial tiene que tener docs que vienen despues de todos los que ya estan)
+void fusionarIndice(IndiceInvertido& indice, const IndiceInvertido& parcial, int desplazamiento) {
+    std::vector<int> ids, frecuencias;
+    for (NodoTermino* t = parcial.inicio; t != nullptr; t = t->siguiente) {
+        NodoTermino* destino = obtenerTermino(indice, t->termino, t->hash);
+        descomprimirLista(t->listaDocumentos, ids, &frecuencias);
+        for (size_t i = 0; i < ids.size(); ++i)
+            insertarDocumento(destino->postings, ids[i] + desplazamiento, frecuencias[i]);
+    }
+    // y la tabla de documentos, tambien corrida
+    indice.largoDocumentos.resize(desplazamiento + parcial.numDocs + 1, 0);
+    for (int id = 1; id <= parcial.numDocs; ++id)
+        indice.largoDocumentos[id + desplazamiento] = parcial.largoDocumentos[id];
+    indice.numDocs = desplazamiento + parcial.numDocs;
+}
+
+// version con varios hilos: partimos el archivo en rangos de bytes (cortando en fin de linea),
+// cada hilo arma su propio indice parcial y al final se juntan en orden.
+// como cada parcial cuenta sus lineas, el id global es el local mas las lineas de los anteriores
+int construirIndiceParalelo(IndiceInvertido& indice, const std::string& archivoDocumentos,
+                            const FiltroStopwords& stopwords, int numHilos) {
+    if (numHilos <= 1) return construirIndice(indice, archivoDocumentos, stopwords);
+
+    // el archivo se mapea una vez y todos los hilos leen del mismo mapa
+    ArchivoDocumentos documentos;
+    if (!abrirDocumentos(archivoDocumentos, documentos)) {
+        std::cerr << "❌ Error: no se pudo abrir " << archivoDocumentos << "\n";
+        return -1;
+    }
+    unsigned long long tam = documentos.tam;
+
+    std::vector<IndiceInvertido> parciales(numHilos);
+    std::vector<int> lineas(numHilos, 0);
+    std::vector<std::thread> hilos;
+    for (int h = 0; h < numHilos; ++h) {
+        inicializarIndice(parciales[h]);
+        unsigned long long inicio = tam * h / numHilos;
+        unsigned long long fin = tam * (h + 1) / numHilos;
+        hilos.emplace_back([&, h, inicio, fin]() {
+            lineas[h] = indexarRango(parciales[h], documentos, inicio, fin, stopwords);
+            finalizarIndice(parciales[h]);
+        });
+    }
+    for (std::thread& hilo : hilos) hilo.join();
+    cerrarDocumentos(documentos);
+
+    // juntamos los parciales en orden, asi las listas se siguen armando solo agregando al final
+    int desplazamiento = 0;
+    for (int h = 0; h < numHilos; ++h) {
+        fusionarIndice(indice, parciales[h], desplazamiento);
+        desplazamiento += lineas[h];
+        liberarIndice(parciales[h]);
+    }
+    finalizarIndice(indice);
+    return desplazamiento;
+}
+
+// cada lista se descomprime, se le cambian los ids, se ordena de nuevo y se vuelve a comprimir.
+// si los ids nuevos juntan docs parecidos las diferencias quedan mas chicas y la lista ocupa menos
+void renumerarIndice(IndiceInvertido& indice, const std::vector<int>& nuevoId) {
+    std::vector<int> ids, frecuencias;
+    std::vector<std::pair<int, int>> pares; // (id nuevo, frecuencia)
+    for (NodoTermino* actual = indice.inicio; actual != nullptr; actual = actual->siguiente) {
+        descomprimirLista(actual->listaDocumentos, ids, &frecuencias);
+        pares.resize(ids.size());
+        for (size_t i = 0; i < ids.size(); ++i) pares[i] = std::make_pair(nuevoId[ids[i]], frecuencias[i]);
+        std::sort(pares.begin(), pares.end());
+        for (size_t i = 0; i < pares.size(); ++i) {
+            ids[i] = pares[i].first;
+            frecuencias[i] = pares[i].second;
+        }
+        ConstructorPostings& lista = actual->postings;
+        rearmarLista(lista, ids, frecuencias);
+        comprimirPendientes(lista);
+        lista.datos.shrink_to_fit();
+        lista.saltos.shrink_to_fit();
+        std::vector<int>().swap(lista.idsPendientes);
+        std::vector<int>().swap(lista.frecPendientes);
+        actual->listaDocumentos = vistaPostings(lista);
+    }
+
+    // la tabla de documentos tambien cambia de lugar, y guardamos de donde vino cada uno
+    // (si ya estaba renumerado, el original es el de antes)
+    std::vector<int> largos(indice.numDocs + 1, 0), originales(indice.numDocs + 1, 0);
+    for (int id = 1; id <= indice.numDocs; ++id) {
+        largos[nuevoId[id]] = id < static_cast<int>(indice.largoDocumentos.size()) ? indice.largoDocumentos[id] : 0;
+        originales[nuevoId[id]] = indice.idsOriginales.empty() ? id : indice.idsOriginales[id];
+    }
+    indice.largoDocumentos.swap(largos);
+    indice.idsOriginales.swap(originales);
 }
 
 // funcion para imprimir el indice mostrando la frecuencia de cada palabra en cada doc
@@ -73,10 +417,10 @@ void mostrarIndiceConFrecuencia(const IndiceInvertido& indice) {
     NodoTermino* actual = indice.inicio;
     while (actual != nullptr) {
         std::cout << actual->termino << " -> ";
-        NodoDoc* doc = actual->listaDocumentos;
-        while (doc != nullptr) {
-            std::cout << "[doc" << doc->idDocumento << ": " << doc->frecuencia << "] ";
-            doc = doc->siguiente;
+        std::vector<int> ids, frecuencias;
+        descomprimirLista(actual->listaDocumentos, ids, &frecuencias);
+        for (size_t i = 0; i < ids.size(); ++i) {
+            std::cout << "[doc" << ids[i] << ": " << frecuencias[i] << "] ";
         }
         std::cout << std::endl;
         actual = actual->siguiente;
@@ -88,17 +432,9 @@ void mostrarIndiceConIDsComprimidos(const IndiceInvertido& indice) {
     NodoTermino* actual = indice.inicio;
     while (actual != nullptr) {
         std::cout << actual->termino << " -> ";
+        // los ids ya estan ordenados de menor a mayor en la posting list
         std::vector<int> ids;
-
-        // juntamos todos los ids en un vector para poder ordenarlos
-        NodoDoc* doc = actual->listaDocumentos;
-        while (doc != nullptr) {
-            ids.push_back(doc->idDocumento);
-            doc = doc->siguiente;
-        }
-
-        // los ordenamos de menor a mayor
-        std::sort(ids.begin(), ids.end());
+        descomprimirLista(actual->listaDocumentos, ids, nullptr);
 
         if (!ids.empty()) {
             std::cout << "[" << ids[0]; // imprimimos el primer id
@@ -116,22 +452,18 @@ void mostrarIndiceConIDsComprimidos(const IndiceInvertido& indice) {
 
 // funcion importantisima para liberar toda la memoria del indice
 void liberarIndice(IndiceInvertido& indice) {
-    // recorremos cada termino
+    // recorremos cada termino y lo borramos (sus posting lists son vectores y se liberan solos)
     NodoTermino* actual = indice.inicio;
     while (actual != nullptr) {
-        // y para cada termino, recorremos su lista de documentos y los borramos uno por uno
-        NodoDoc* doc = actual->listaDocumentos;
-        while (doc != nullptr) {
-            NodoDoc* tempDoc = doc;
-            doc = doc->siguiente;
-            delete tempDoc;
-        }
-        
-        // una vez borrada la lista de docs, borramos el nodo del termino
         NodoTermino* tempTerm = actual;
         actual = actual->siguiente;
         delete tempTerm;
     }
     // al final, el indice queda vacio
     indice.inicio = nullptr;
+    indice.numTerminos = 0;
+    indice.numDocs = 0;
+    std::vector<int>().swap(indice.largoDocumentos);
+    std::vector<int>().swap(indice.idsOriginales);
+    indice.tabla.assign(CAPACIDAD_INICIAL_TABLA, nullptr);
 }
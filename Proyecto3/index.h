@@ -2,35 +2,109 @@
 #define INDEX_H
 
 #include <string>
+#include <string_view>
 #include <map>
+#include <vector>
+#include "utils.h"
 
 // para que no se compile dos veces el mismo archivo
 
-// este es el nodo para la lista de documentos (la posting list)
-struct NodoDoc {
-    int idDocumento;        // el id del doc
-    int frecuencia;         // cuantas veces sale la palabra en ese doc
-    NodoDoc* siguiente;     // puntero al siguiente doc de la lista
+// cuantos documentos van en cada bloque comprimido de una posting list
+const int TAM_BLOQUE = 128;
+
+// una entrada de la tabla de saltos, hay una por bloque
+// con esto se puede saber si un id puede estar en un bloque sin descomprimirlo
+struct SaltoBloque {
+    int primerId;           // el primer id del bloque (los demas se guardan como diferencias)
+    int ultimoId;           // el ultimo id del bloque
+    unsigned int offset;    // donde empieza el bloque en el array de bytes
+};
+
+// la lista de documentos de un termino (la posting list), comprimida
+// los ids estan ordenados de menor a mayor y se parten en bloques de TAM_BLOQUE.
+// cada bloque guarda las diferencias entre ids y despues las frecuencias, todo en VByte
+// (7 bits por byte), asi un id chico ocupa 1 byte en vez de los 16 de un nodo de lista.
+// esto es solo una vista de lectura, los bytes los guarda el ConstructorPostings del termino
+struct ListaPostings {
+    int numDocs;                    // en cuantos docs sale la palabra (df)
+    int numBloques;                 // cuantos bloques hay (todos llenos menos el ultimo)
+    const SaltoBloque* saltos;      // la tabla de saltos, numBloques entradas
+    const unsigned char* datos;     // los bloques comprimidos
+    int termino;                    // el numero del termino (-1 si no se sabe), para la cache de pares
+    const float* maximos;           // el BM25 maximo de cada bloque (solo en el segmento, si no nullptr)
+    const float* maximosPrior;      // el mayor aporte del pagerank de los docs de cada bloque (idem)
+    float maxPuntaje;               // el BM25 maximo de toda la lista (0 si no hay maximos)
+    float maxPrior;                 // y el mayor aporte del pagerank de sus docs
+};
+
+// lo que se va llenando mientras se construye el indice
+// el ultimo bloque se queda sin comprimir hasta que se llena, asi insertar solo mira la cola
+struct ConstructorPostings {
+    int numDocs;                            // cuantos docs hay en total (comprimidos + pendientes)
+    std::vector<SaltoBloque> saltos;        // la tabla de saltos de los bloques ya comprimidos
+    std::vector<unsigned char> datos;       // los bytes de los bloques ya comprimidos
+    std::vector<int> idsPendientes;         // el bloque que se esta llenando, sin comprimir
+    std::vector<int> frecPendientes;        // las frecuencias de ese bloque
 };
 
 // el nodo para la lista principal, la de las palabras
 struct NodoTermino {
     std::string termino;        // la palabra en si
-    NodoDoc* listaDocumentos;   // un puntero a la lista de todos los docs donde sale esta palabra
+    ConstructorPostings postings;   // donde se van guardando los docs mientras se construye el indice
+    ListaPostings listaDocumentos;  // la lista de todos los docs donde sale esta palabra (lista despues de finalizarIndice)
     NodoTermino* siguiente;     // puntero a la siguiente palabra del indice
+    unsigned int hash;          // el hash de la palabra, lo guardamos para no recalcularlo al agrandar la tabla
+    int numero;                 // en que orden se agrego (de 0 a numTerminos - 1)
 };
 
 // la estructura principal de todo el indice
+// la lista de terminos se sigue usando para recorrer el indice entero (mostrar, liberar)
+// pero para buscar una palabra usamos la tabla hash, asi no hay que recorrer todo el vocabulario
 struct IndiceInvertido {
-    NodoTermino* inicio; // solo necesitamos saber donde empieza la lista de terminos
+    NodoTermino* inicio;                // donde empieza la lista de terminos
+    std::vector<NodoTermino*> tabla;    // tabla hash con direccionamiento abierto (sondeo lineal)
+    int numTerminos;                    // cuantos terminos distintos hay
+    int numDocs;                        // el id de documento mas grande que se vio
+    std::vector<int> largoDocumentos;   // cuantas palabras se indexaron de cada doc (la posicion es el id)
+    std::vector<int> idsOriginales;     // si se renumeraron los docs, el id de linea de cada uno (vacio si no)
 };
 
 
 void inicializarIndice(IndiceInvertido& indice);                 // para empezar el indice de cero
-void insertarTermino(IndiceInvertido& indice, const std::string& termino, int idDocumento); // para meter una palabra y el doc donde salio
-NodoTermino* buscarTermino(IndiceInvertido& indice, const std::string& termino); // para buscar una palabra
+unsigned int hashTermino(std::string_view termino);              // el hash que usa la tabla de terminos (FNV-1a)
+void insertarTermino(IndiceInvertido& indice, std::string_view termino, int idDocumento); // para meter una palabra y el doc donde salio
+NodoTermino* buscarTermino(IndiceInvertido& indice, std::string_view termino); // para buscar una palabra
+void finalizarIndice(IndiceInvertido& indice);                   // comprime los ultimos bloques y deja las listas listas para leer
 void liberarIndice(IndiceInvertido& indice);                     // para borrar todo y no dejar fugas de memoria
 
+// le cambia el id a todos los docs (nuevoId[id], de 1 a numDocs sin repetir) y vuelve a armar
+// todas las posting lists y la tabla de documentos con los ids nuevos. el indice tiene que estar
+// finalizado y queda finalizado. en idsOriginales queda el id que tenia cada doc
+void renumerarIndice(IndiceInvertido& indice, const std::vector<int>& nuevoId);
+
+// lee el archivo de documentos (una linea por doc, el contenido despues del ultimo "||")
+// y mete todas sus palabras al indice (y lo finaliza). devuelve cuantos documentos leyo,
+// o -1 si no se pudo abrir el archivo (el indice queda vacio)
+int construirIndice(IndiceInvertido& indice, const std::string& archivoDocumentos,
+                    const FiltroStopwords& stopwords);
+
+// lo mismo pero con varios hilos: cada uno indexa un pedazo del archivo en su propio indice
+// y despues se juntan. los ids quedan iguales que con construirIndice
+int construirIndiceParalelo(IndiceInvertido& indice, const std::string& archivoDocumentos,
+                            const FiltroStopwords& stopwords, int numHilos);
+
+// un numero en VByte: 7 bits por byte, el bit alto prendido quiere decir que sigue otro byte
+void escribirVByte(std::vector<unsigned char>& datos, unsigned int valor);
+unsigned int leerVByte(const unsigned char*& p); // deja el puntero justo despues
+
+// para leer las posting lists comprimidas
+// descomprime un bloque en ids (y frecuencias si no es nullptr), devuelve cuantos docs tenia
+int decodificarBloque(const ListaPostings& lista, int bloque, int* ids, int* frecuencias);
+// descomprime la lista entera (frecuencias puede ser nullptr)
+void descomprimirLista(const ListaPostings& lista, std::vector<int>& ids, std::vector<int>* frecuencias);
+// cuantos bytes ocupan las posting lists comprimidas (datos + tablas de saltos)
+size_t memoriaPostings(const IndiceInvertido& indice);
+
 // funciones para mostrar el indice, mas que nada para pruebas
 void mostrarIndiceConFrecuencia(const IndiceInvertido& indice);
 void mostrarIndiceConIDsComprimidos(const IndiceInvertido& indice);
@@ -0,0 +1,267 @@
+#include "interseccion.h"
+#include "utils.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// sacamos las palabras de la consulta y buscamos la posting list de cada una
+void obtenerListasConsulta(IndiceInvertido& indice, const std::string& consulta,
+                           const FiltroStopwords& stopwords,
+                           std::vector<ListaPostings>& listas) {
+    listas.clear();
+    Tokenizador tokenizador;
+    iniciarTokenizador(tokenizador, consulta);
+    std::string_view palabra;
+    while (siguientePalabra(tokenizador, palabra)) {
+        if (!esStopword(palabra, stopwords)) {
+            NodoTermino* nodo = buscarTermino(indice, palabra);
+            if (nodo) {
+                listas.push_back(nodo->listaDocumentos);
+                listas.back().termino = nodo->numero;
+            }
+        }
+    }
+}
+
+// igual, pero el diccionario es el del segmento
+void obtenerListasConsulta(const Segmento& segmento, const std::string& consulta,
+                           const FiltroStopwords& stopwords,
+                           std::vector<ListaPostings>& listas) {
+    listas.clear();
+    Tokenizador tokenizador;
+    iniciarTokenizador(tokenizador, consulta);
+    std::string_view palabra;
+    ListaPostings lista;
+    while (siguientePalabra(tokenizador, palabra)) {
+        if (!esStopword(palabra, stopwords)) {
+            if (buscarTerminoSegmento(segmento, palabra, lista)) listas.push_back(lista);
+        }
+    }
+}
+
+// mezcla normal de dos listas ordenadas, la usamos para los restos que no llenan un bloque
+size_t interseccionMezcla(const int* a, size_t na, const int* b, size_t nb, int* salida) {
+    size_t i = 0, j = 0, n = 0;
+    while (i < na && j < nb) {
+        if (a[i] < b[j]) i++;
+        else if (b[j] < a[i]) j++;
+        else { salida[n++] = a[i]; i++; j++; }
+    }
+    return n;
+}
+
+// galloping (busqueda exponencial): para cada id de la lista corta saltamos en la larga
+// de 1, 2, 4, 8... posiciones hasta pasarnos y despues busqueda binaria en ese tramo
+// cuesta O(na * log(nb / na)) en vez de O(na + nb)
+size_t interseccionGalloping(const int* a, size_t na, const int* b, size_t nb, int* salida) {
+    size_t j = 0, n = 0;
+    for (size_t i = 0; i < na && j < nb; ++i) {
+        int objetivo = a[i];
+        if (b[j] < objetivo) {
+            // saltamos hasta encontrar un b mayor o igual al objetivo
+            size_t paso = 1;
+            size_t hasta = j + 1;
+            while (hasta < nb && b[hasta] < objetivo) {
+                j = hasta;
+                paso *= 2;
+                hasta = j + paso;
+            }
+            if (hasta > nb) hasta = nb;
+            // y ahora binaria entre j y hasta
+            j = std::lower_bound(b + j, b + hasta, objetivo) - b;
+            if (j == nb) break;
+        }
+        if (b[j] == objetivo) salida[n++] = objetivo;
+    }
+    return n;
+}
+
+// interseccion por bloques de 4 ids: comparamos 4 de a contra 4 de b (rotados) de una vez
+// y avanzamos el bloque que tenga el maximo mas chico. sirve cuando las listas son parecidas
+size_t interseccionSIMD(const int* a, size_t na, const int* b, size_t nb, int* salida) {
+    size_t i = 0, j = 0, n = 0;
+#if defined(__SSE2__)
+    while (i + 4 <= na && j + 4 <= nb) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + j));
+        // comparamos contra las 4 rotaciones de vb, asi cada id de a se compara con los 4 de b
+        __m128i iguales = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi32(va, vb),
+                         _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1)))),
+            _mm_or_si128(_mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2))),
+                         _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(2, 1, 0, 3)))));
+        int mascara = _mm_movemask_ps(_mm_castsi128_ps(iguales));
+
+        int maxA = a[i + 3];
+        int maxB = b[j + 3];
+        // copiamos los que coincidieron (antes de escribir, porque salida puede ser a)
+        if (mascara != 0) {
+            int bloque[4] = {a[i], a[i + 1], a[i + 2], a[i + 3]};
+            for (int k = 0; k < 4; ++k)
+                if (mascara & (1 << k)) salida[n++] = bloque[k];
+        }
+        if (maxA <= maxB) i += 4;
+        if (maxB <= maxA) j += 4;
+    }
+#endif
+    // lo que queda lo hacemos con la mezcla normal
+    return n + interseccionMezcla(a + i, na - i, b + j, nb - j, salida + n);
+}
+
+// elegimos el algoritmo segun que tan distintos son los tamaños
+size_t intersectarPar(const int* a, size_t na, const int* b, size_t nb, int* salida) {
+    if (na == 0 || nb == 0) return 0;
+    if (nb / na >= RAZON_GALLOPING) return interseccionGalloping(a, na, b, nb, salida);
+    return interseccionSIMD(a, na, b, nb, salida);
+}
+
+// intersecta los candidatos (ordenados) con una lista comprimida, bloque por bloque.
+// con la tabla de saltos sabemos que bloques pueden tener candidatos, y solo esos se descomprimen
+// los que quedan se escriben al principio del mismo array de candidatos
+size_t intersectarConLista(int* candidatos, size_t n, const ListaPostings& lista) {
+    int bloque[TAM_BLOQUE];
+    size_t i = 0, escritos = 0;
+    int b = 0;
+    while (i < n && b < lista.numBloques) {
+        // si el bloque termina antes del candidato, buscamos (binaria) el primer bloque que llegue
+        if (lista.saltos[b].ultimoId < candidatos[i]) {
+            b = std::lower_bound(lista.saltos + b, lista.saltos + lista.numBloques, candidatos[i],
+                                 [](const SaltoBloque& salto, int id) { return salto.ultimoId < id; })
+                - lista.saltos;
+            if (b == lista.numBloques) break;
+        }
+        // los candidatos que caen hasta el final de este bloque
+        size_t fin = std::upper_bound(candidatos + i, candidatos + n, lista.saltos[b].ultimoId) - candidatos;
+        // si todos son menores que el primer id del bloque no hace falta ni descomprimirlo
+        if (candidatos[fin - 1] >= lista.saltos[b].primerId) {
+            int cuantos = decodificarBloque(lista, b, bloque, nullptr);
+            escritos += intersectarPar(candidatos + i, fin - i, bloque, cuantos, candidatos + escritos);
+        }
+        i = fin;
+        b++;
+    }
+    return escritos;
+}
+
+// interseccion de varias listas
+void intersectarListas(std::vector<ListaPostings>& listas, std::vector<int>& resultado) {
+    resultado.clear();
+    if (listas.empty()) return;
+
+    // ordenamos por frecuencia de documento (df), la mas corta primero
+    // asi el resultado parcial nunca es mas grande que la lista mas corta
+    std::sort(listas.begin(), listas.end(), [](const ListaPostings& x, const ListaPostings& y) {
+        return x.numDocs < y.numDocs;
+    });
+
+    // la lista mas corta la descomprimimos entera en el resultado, son los candidatos
+    // (el vector se reusa entre consultas, asi que casi nunca pide memoria)
+    const ListaPostings& primera = listas[0];
+    resultado.resize(primera.numDocs);
+    for (int b = 0; b < primera.numBloques; ++b)
+        decodificarBloque(primera, b, resultado.data() + b * TAM_BLOQUE, nullptr);
+
+    // y despues la vamos achicando con las demas, sin descomprimirlas enteras
+    size_t n = resultado.size();
+    for (size_t k = 1; k < listas.size() && n > 0; ++k) {
+        n = intersectarConLista(resultado.data(), n, listas[k]);
+    }
+    resultado.resize(n); // achicar no libera memoria, el vector queda listo para la proxima
+}
+
+void intersectarPrimeros(std::vector<ListaPostings>& listas, size_t k, std::vector<int>& resultado) {
+    resultado.clear();
+    if (listas.empty() || k == 0) return;
+    std::sort(listas.begin(), listas.end(), [](const ListaPostings& x, const ListaPostings& y) {
+        return x.numDocs < y.numDocs;
+    });
+
+    // cada bloque de la corta son candidatos en orden, asi que lo que sale de un bloque va antes
+    // que lo del siguiente. intersectarConLista busca el bloque con la tabla de saltos, no recorre
+    const ListaPostings& primera = listas[0];
+    int bloque[TAM_BLOQUE];
+    for (int b = 0; b < primera.numBloques && resultado.size() < k; ++b) {
+        size_t n = decodificarBloque(primera, b, bloque, nullptr);
+        for (size_t j = 1; j < listas.size() && n > 0; ++j)
+            n = intersectarConLista(bloque, n, listas[j]);
+        resultado.insert(resultado.end(), bloque, bloque + n);
+    }
+    if (resultado.size() > k) resultado.resize(k);
+}
+
+void inicializarCacheIntersecciones(CacheIntersecciones& pares, size_t bytesMaximos) {
+    inicializarCache(pares.cache, 1024, 1024, POLITICA_LRU);
+    limitarBytesCache(pares.cache, bytesMaximos, false);
+    pares.consultas = 0;
+    pares.aciertos = 0;
+    pares.postingsAhorrados = 0;
+    pares.postingsTotales = 0;
+}
+
+void liberarCacheIntersecciones(CacheIntersecciones& pares) {
+    liberarCache(pares.cache);
+}
+
+// la clave de un par: los dos numeros de termino (el menor primero) en 8 bytes
+std::string clavePar(int a, int b) {
+    if (a > b) std::swap(a, b);
+    char clave[8];
+    std::memcpy(clave, &a, 4);
+    std::memcpy(clave + 4, &b, 4);
+    return std::string(clave, 8);
+}
+
+void intersectarListas(std::vector<ListaPostings>& listas, std::vector<int>& resultado,
+                       CacheIntersecciones& pares) {
+    if (listas.size() < 2) {
+        intersectarListas(listas, resultado);
+        return;
+    }
+    std::sort(listas.begin(), listas.end(), [](const ListaPostings& x, const ListaPostings& y) {
+        return x.numDocs < y.numDocs;
+    });
+    pares.consultas++;
+    for (const ListaPostings& lista : listas) pares.postingsTotales += lista.numDocs;
+
+    // probamos todos los pares (las consultas tienen pocas palabras) y nos quedamos con el mas chico
+    size_t primera = 0, segunda = 1;
+    bool encontrado = false;
+    std::vector<int> otro;
+    for (size_t i = 0; i < listas.size(); ++i) {
+        for (size_t j = i + 1; j < listas.size(); ++j) {
+            if (listas[i].termino < 0 || listas[j].termino < 0) continue;
+            std::vector<int>& destino = encontrado ? otro : resultado;
+            if (!buscarCache(pares.cache, clavePar(listas[i].termino, listas[j].termino), destino)) continue;
+            if (encontrado && otro.size() >= resultado.size()) continue;
+            if (encontrado) resultado.swap(otro);
+            encontrado = true;
+            primera = i;
+            segunda = j;
+        }
+    }
+
+    if (encontrado) {
+        pares.aciertos++;
+        pares.postingsAhorrados += listas[primera].numDocs + listas[segunda].numDocs;
+    } else {
+        // como siempre: la mas corta descomprimida y achicada con la segunda
+        const ListaPostings& corta = listas[0];
+        resultado.resize(corta.numDocs);
+        for (int b = 0; b < corta.numBloques; ++b)
+            decodificarBloque(corta, b, resultado.data() + b * TAM_BLOQUE, nullptr);
+        resultado.resize(intersectarConLista(resultado.data(), resultado.size(), listas[1]));
+        if (corta.termino >= 0 && listas[1].termino >= 0)
+            insertarCache(pares.cache, clavePar(corta.termino, listas[1].termino), resultado);
+    }
+
+    // y seguimos con las que no estan en el par
+    size_t n = resultado.size();
+    for (size_t k = 0; k < listas.size() && n > 0; ++k) {
+        if (k == primera || k == segunda) continue;
+        n = intersectarConLista(resultado.data(), n, listas[k]);
+    }
+    resultado.resize(n);
+}
@@ -0,0 +1,68 @@
+#ifndef INTERSECCION_H
+#define INTERSECCION_H
+
+#include <string>
+#include "utils.h"
+#include <vector>
+#include "index.h"
+#include "segmento.h"
+#include "cache.h"
+
+// para que no se incluya dos veces
+// aqui va todo lo de intersectar posting lists ordenadas (las consultas AND)
+
+// si una lista es mas de este numero de veces mas larga que la otra usamos galloping,
+// si no, comparamos por bloques con SIMD
+const size_t RAZON_GALLOPING = 32;
+
+// busca las posting lists de las palabras de una consulta (limpia y saca stopwords)
+// las palabras que no estan en el indice se ignoran, igual que antes
+// las listas son vistas (punteros a los bloques), copiarlas no copia los datos
+void obtenerListasConsulta(IndiceInvertido& indice, const std::string& consulta,
+                           const FiltroStopwords& stopwords,
+                           std::vector<ListaPostings>& listas);
+// lo mismo pero buscando en un segmento ya congelado (o abierto de disco)
+void obtenerListasConsulta(const Segmento& segmento, const std::string& consulta,
+                           const FiltroStopwords& stopwords,
+                           std::vector<ListaPostings>& listas);
+
+// interseccion de dos arrays ordenados, devuelven cuantos ids escribieron en salida
+// salida puede ser el mismo array que a (se escribe siempre detras de lo que se lee)
+size_t interseccionGalloping(const int* a, size_t na, const int* b, size_t nb, int* salida); // a es la corta
+size_t interseccionSIMD(const int* a, size_t na, const int* b, size_t nb, int* salida);      // tamaños parecidos
+size_t intersectarPar(const int* a, size_t na, const int* b, size_t nb, int* salida);        // elige una de las dos
+
+// intersecta candidatos ordenados con una posting list comprimida, descomprimiendo solo
+// los bloques que pueden tener candidatos. deja el resultado al principio de candidatos
+size_t intersectarConLista(int* candidatos, size_t n, const ListaPostings& lista);
+
+// intersecta todas las listas (ordena por df, de la mas corta a la mas larga)
+// el resultado queda ordenado de menor a mayor. resultado se reusa entre consultas para no pedir memoria
+void intersectarListas(std::vector<ListaPostings>& listas, std::vector<int>& resultado);
+
+// solo los primeros k ids de la interseccion (los mas chicos). la lista mas corta se descomprime
+// de a un bloque y se intersecta con las demas, y se corta apenas hay k. si los docs estan
+// numerados por pagerank (renumerarIndice) estos son los k de mas pagerank
+void intersectarPrimeros(std::vector<ListaPostings>& listas, size_t k, std::vector<int>& resultado);
+
+// cache de segundo nivel: la interseccion de dos terminos, guardada por sus numeros de termino.
+// la cache de consultas solo sirve si se repite la consulta entera, pero muchas comparten
+// un par de palabras ("a b c" y "a b d"). aca se guardan esos pares ya intersectados
+struct CacheIntersecciones {
+    Cache cache;                    // LRU limitada por bytes, la clave son los dos numeros (el menor primero)
+    long long consultas;            // consultas de 2 o mas terminos que pasaron por aca
+    long long aciertos;             // en cuantas se encontro algun par ya intersectado
+    long long postingsAhorrados;    // los docs de las dos listas de cada par encontrado (lo que no se recorrio)
+    long long postingsTotales;      // los docs de todas las listas de esas consultas
+};
+
+void inicializarCacheIntersecciones(CacheIntersecciones& pares, size_t bytesMaximos);
+void liberarCacheIntersecciones(CacheIntersecciones& pares);
+
+// igual que intersectarListas, pero antes se fija si algun par de las listas ya esta en la cache
+// (si hay varios empieza por el de menos resultados) y sigue con las demas listas desde ahi.
+// si no hay ninguno intersecta las dos mas cortas como siempre y guarda ese par
+void intersectarListas(std::vector<ListaPostings>& listas, std::vector<int>& resultado,
+                       CacheIntersecciones& pares);
+
+#endif // INTERSECCION_H
@@ -8,165 +8,126 @@
 #include <chrono>
 #include <iomanip>
 #include <cctype>
+#include <cstdlib>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <cmath>
 
 #include "index.h"
 #include "utils.h"
 #include "grafo.h"
 #include "cache.h"
+#include "interseccion.h"
+#include "segmento.h"
+#include "ranking.h"
 
 using namespace std;
 using namespace std::chrono;
 
-// funcion clave para la cache
-// la idea es que "big house" y "house big" den la misma clave para que funcione el cache
-string normalizarConsulta(string s) {
-    // poner en minusculas
-    transform(s.begin(), s.end(), s.begin(),
-                   [](unsigned char c){ return tolower(c); });
-
-    // separar las palabras en un vector
-    istringstream iss(s);
-    string palabra;
-    vector<string> palabras;
-    while (iss >> palabra) {
-        palabras.push_back(palabra);
-    }
+// esto es para mostrar el progreso en la consola
+void mostrarProgresoGrafo(size_t hechas, size_t total) {
+    double pct = hechas * 100.0 / total;
+    cout << fixed << setprecision(2)
+         << "⏳ Construyendo grafo... " << hechas << "/" << total
+         << " (" << pct << "%)\r" << flush;
+}
 
-    //ordenar las palabras alfabeticamente
-    sort(palabras.begin(), palabras.end());
+// evalua las consultas desde..hasta del log y anota los pares del top 10 de cada una
+// si mostrarProgreso es true va mostrando en la consola cuantas consultas (de todos los hilos) van
+void reproducirRango(IndiceInvertido& indice, const vector<string>& consultas, size_t desde, size_t hasta,
+                     const FiltroStopwords& stopwords, vector<unsigned long long>& pares,
+                     atomic<size_t>& procesadas, bool mostrarProgreso) {
+    // los vectores se reusan entre consultas para no pedir memoria cada vez
+    vector<ListaPostings> listas;
+    vector<int> resultado;
+    size_t total = consultas.size();
+    for (size_t i = desde; i < hasta; ++i) {
+        // buscamos las listas de la consulta en nuestro indice y las intersectamos
+        obtenerListasConsulta(indice, consultas[i], stopwords, listas);
+        intersectarListas(listas, resultado); // salen de menor a mayor
 
-    // unir las palabras para crear la clave final
-    string clave_normalizada;
-    for (size_t i = 0; i < palabras.size(); ++i) {
-        clave_normalizada += palabras[i] + (i == palabras.size() - 1 ? "" : " ");
-    }
-    
-    return clave_normalizada;
-}
+        // si la consulta dio resultados
+        if (!resultado.empty()) {
+            // tomamos solo los primeros 10 (top-K)
+            size_t topK = min<size_t>(resultado.size(), 10);
+            // y anotamos una arista entre cada par de documentos
+            for (size_t j = 0; j < topK; ++j)
+                for (size_t k = j + 1; k < topK; ++k)
+                    pares.push_back(claveArista(resultado[j], resultado[k]));
+        }
 
-// funcion para buscar el puntaje de pagerank de un doc especifico
-double obtenerScorePageRank(const Grafo& grafo, int id) {
-    // revisamos que el grafo no este vacio o corrupto
-    if (!grafo.pageRank || !grafo.ids || grafo.numNodos == 0) {
-        cerr << "❌ Error: grafo no inicializado correctamente.\n";
-        return 0.0;
+        // esto es para mostrar el progreso en la consola (lo muestra un solo hilo)
+        size_t hechas = ++procesadas;
+        if (mostrarProgreso) mostrarProgresoGrafo(hechas, total);
     }
-    //buscamos el id en el array de ids y devolvemos el puntaje que esta en la misma posicion
-    for (int i = 0; i < grafo.numNodos; ++i)
-        if (grafo.ids[i] == id)
-            return grafo.pageRank[i];
-    return 0.0; // si no lo encuentra, score 0
 }
 
-int main(int argc, char* argv[]) {
-    // revisamos que nos pasen los 3 archivos
-    if (argc != 4) {
-        cout << "Uso: " << argv[0] << " <documentos.dat> <consultas.dat> <stopwords.txt>\n";
-        return 1;
-    }
-
-    string archivoDocumentos = argv[1];
-    string archivoConsultas = argv[2];
-    string archivoStopwords = argv[3];
+// el indice ya no cambia, asi que varios hilos pueden evaluar consultas a la vez: cada uno toma un
+// pedazo seguido del log y anota sus pares en su propio buffer. los buffers se juntan en el orden
+// del log, asi los pares quedan iguales con cualquier cantidad de hilos
+void reproducirLog(IndiceInvertido& indice, const vector<string>& consultas, const FiltroStopwords& stopwords,
+                   int numHilos, vector<unsigned long long>& pares) {
+    size_t total = consultas.size();
+    numHilos = max(1, min<int>(numHilos, static_cast<int>(total)));
+    vector<vector<unsigned long long>> paresPorHilo(numHilos);
+    atomic<size_t> procesadas(0);
+    vector<thread> hilos;
+    for (int h = 1; h < numHilos; ++h)
+        hilos.emplace_back(reproducirRango, ref(indice), cref(consultas), total * h / numHilos,
+                           total * (h + 1) / numHilos, cref(stopwords), ref(paresPorHilo[h]), ref(procesadas), false);
+    // el hilo principal hace el primer pedazo y muestra el progreso
+    reproducirRango(indice, consultas, 0, total / numHilos, stopwords, paresPorHilo[0], procesadas, true);
+    for (thread& hilo : hilos) hilo.join();
+    if (total > 0) mostrarProgresoGrafo(total, total);
+
+    pares.clear();
+    for (const vector<unsigned long long>& parcial : paresPorHilo)
+        pares.insert(pares.end(), parcial.begin(), parcial.end());
+}
 
+// la fase offline: arma el indice, el grafo con el log de consultas y el pagerank,
+// y deja todo congelado en un segmento (en memoria) listo para responder consultas.
+// con reordenar los docs se renumeran de mayor a menor pagerank antes de congelar.
+// bitsPageRank es cuanto ocupa el pagerank de cada doc en el segmento (64, 32 o 16).
+// devuelve false si no se pudo leer el archivo de documentos
+bool faseOffline(const string& archivoDocumentos, const string& archivoConsultas,
+                 const FiltroStopwords& stopwords, int numHilos, bool reordenar, int bitsPageRank,
+                 const FirmasSegmento& firmas, Segmento& segmento) {
     // Construir el Indice Invertido (Logica del P1) 
     IndiceInvertido indice;
     inicializarIndice(indice);
-    set<string> stopwords;
-    cargarStopwords(archivoStopwords, stopwords); //cargamos las stopwords para ignorarlas
 
-    // leemos el archivo de documentos linea por linea
-    ifstream documentos(archivoDocumentos);
-    string linea;
-    int idDoc = 1;
-    while (getline(documentos, linea)) {
-        size_t pos = linea.rfind("||");
-        if (pos != string::npos) {
-            string contenido = linea.substr(pos + 2);
-            istringstream iss(contenido);
-            string palabra;
-            // y procesamos palabra por palabra
-            while (iss >> palabra) {
-                string limpia = limpiarPalabra(palabra);
-                // si no es stopword, la metemos al indice
-                if (!limpia.empty() && !esStopword(limpia, stopwords))
-                    insertarTermino(indice, limpia, idDoc);
-            }
-        }
-        idDoc++;
+    // leemos el archivo de documentos linea por linea y armamos el indice
+    // (con --threads N se reparte el archivo entre N hilos)
+    high_resolution_clock::time_point inicioIndice = high_resolution_clock::now();
+    if (construirIndiceParalelo(indice, archivoDocumentos, stopwords, numHilos) < 0) {
+        liberarIndice(indice);
+        return false;
     }
-    documentos.close();
+    duration<double> tiempoIndice = duration_cast<duration<double>>(high_resolution_clock::now() - inicioIndice);
+    cout << "Índice construido con " << numHilos << " hilo(s) en " << fixed << setprecision(3)
+         << tiempoIndice.count() << " segundos\n";
 
     // construir el Grafo (Logica del P2 - Offline) 
     Grafo grafo;
     high_resolution_clock::time_point inicioGrafo = high_resolution_clock::now();
-    inicializarGrafo(grafo, 2000); // 2000 es el maximo de nodos que esperamos
+    inicializarGrafo(grafo); // ya no tiene maximo de nodos, crece con las aristas
 
     // leemos todas las consultas del log para construir el grafo
     ifstream consultas(archivoConsultas);
+    string linea;
     vector<string> todasConsultas;
     while (getline(consultas, linea)) {
         if (!linea.empty()) todasConsultas.push_back(linea);
     }
     consultas.close();
 
-    // ahora procesamos cada consulta del log
-    size_t total = todasConsultas.size();
-    for (size_t i = 0; i < total; ++i) {
-        const auto& consulta = todasConsultas[i];
-
-        // esto es para mostrar el progreso en la consola
-        double pct = (i + 1) * 100.0 / total;
-        cout << fixed << setprecision(2)
-             << "⏳ Construyendo grafo... " << (i + 1) << "/" << total
-             << " (" << pct << "%)\r" << flush;
-        
-        // buscamos los resultados de la consulta en nuestro indice
-        istringstream iss(consulta);
-        string palabra;
-        vector<NodoDoc*> listas;
-        while (iss >> palabra) {
-            string limpia = limpiarPalabra(palabra);
-            if (!limpia.empty() && !esStopword(limpia, stopwords)) {
-                NodoTermino* nodo = buscarTermino(indice, limpia);
-                if (nodo) listas.push_back(nodo->listaDocumentos);
-            }
-        }
-
-        // esta es la logica de interseccion de listas
-        set<int> resultado;
-        if (!listas.empty() && listas[0]) {
-            NodoDoc* base = listas[0];
-            while (base) {
-                bool comun = true;
-                for (size_t j = 1; j < listas.size(); ++j) {
-                    NodoDoc* aux = listas[j];
-                    bool encontrado = false;
-                    while (aux) {
-                        if (aux->idDocumento == base->idDocumento) {
-                            encontrado = true;
-                            break;
-                        }
-                        aux = aux->siguiente;
-                    }
-                    if (!encontrado) { comun = false; break; }
-                }
-                if (comun) resultado.insert(base->idDocumento);
-                base = base->siguiente;
-            }
-        }
-
-        // si la consulta dio resultados
-        if (!resultado.empty()) {
-            // tomamos solo los primeros 10 (top-K)
-            vector<int> topDocs(resultado.begin(), resultado.end());
-            if (topDocs.size() > 10) topDocs.resize(10);
-            // y creamos una arista entre cada par de documentos
-            for (size_t j = 0; j < topDocs.size(); ++j)
-                for (size_t k = j + 1; k < topDocs.size(); ++k)
-                    agregarArista(grafo, topDocs[j], topDocs[k]);
-        }
-    }
+    // ahora procesamos cada consulta del log, repartidas entre los hilos
+    vector<unsigned long long> pares; // todos los pares de docs del log, el grafo se arma al final de una vez
+    reproducirLog(indice, todasConsultas, stopwords, numHilos, pares);
+    // juntamos los pares repetidos y armamos el grafo en formato CSR
+    agregarLote(grafo, pares);
     cout << "\nGrafo construido." << endl;
 
     high_resolution_clock::time_point finGrafo = high_resolution_clock::now();
@@ -174,7 +135,7 @@ int main(int argc, char* argv[]) {
 
     // Calcular PageRank 
     high_resolution_clock::time_point inicioPR = high_resolution_clock::now();
-    int iteracionesPageRank = calcularPageRank(grafo, 20, 0.85); 
+    int iteracionesPageRank = calcularPageRankParalelo(grafo, 20, 0.85, numHilos);
     high_resolution_clock::time_point finPR = high_resolution_clock::now();
     duration<double> tiempoPR = duration_cast<duration<double>>(finPR - inicioPR);
 
@@ -186,95 +147,312 @@ int main(int argc, char* argv[]) {
     cout << "PageRank convergió en: " << iteracionesPageRank << " iteraciones\n";
     cout << "Tiempo de construcción del grafo: " << fixed << setprecision(3) << tiempoGrafo.count() << " segundos\n";
     cout << "Tiempo de cálculo de PageRank: " << fixed << setprecision(3) << tiempoPR.count() << " segundos\n";
-    
-    // bucle Interactivo con Cache (Logica del P3) 
-    Cache cache;
-    inicializarCache(cache, 10, 53); // inicializamos nuestra cache con capacidad 10
-    int hits = 0, misses = 0, reemplazos = 0, inserciones = 0; // variables para contar las metricas
 
-    string consultaInput;
-    cout << "\n✅ Sistema listo. Ingrese su consulta." << endl;
+    // el pagerank queda en una tabla por id de documento, y el grafo ya no hace falta
+    TablaPageRank tablaPageRank;
+    armarTablaPageRank(grafo, indice.numDocs, bitsPageRank, tablaPageRank);
+    liberarGrafo(grafo);
+    cout << "Tabla de PageRank: " << indice.numDocs << " documentos, " << bytesTablaPageRank(tablaPageRank)
+         << " bytes (" << bitsPageRank << " bits por documento)\n";
+
+    // el grafo y el log ya se armaron con los ids de linea, ahora se pueden cambiar
+    if (reordenar) {
+        high_resolution_clock::time_point inicioOrden = high_resolution_clock::now();
+        size_t bytesAntes = memoriaPostings(indice);
+        vector<int> nuevoId;
+        ordenPorPageRank(tablaPageRank, indice.numDocs, nuevoId);
+        renumerarIndice(indice, nuevoId);
+        renumerarTablaPageRank(tablaPageRank, nuevoId);
+        duration<double> tiempoOrden = duration_cast<duration<double>>(high_resolution_clock::now() - inicioOrden);
+        cout << "Documentos renumerados por PageRank en " << fixed << setprecision(3) << tiempoOrden.count()
+             << " segundos (posting lists: " << bytesAntes << " -> " << memoriaPostings(indice) << " bytes)\n";
+    }
+    // congelamos el indice y el pagerank en un segmento
+    construirSegmento(indice, tablaPageRank, firmas, segmento);
 
-    // el bucle principal, se ejecuta hasta que el usuario escriba "exit"
-    while (true) {
-        cout << "\n> ";
-        getline(cin, consultaInput);
-        if (consultaInput == "exit") break;
+    // el segmento ya tiene todo lo que hace falta para responder consultas
+    liberarIndice(indice);
+    liberarTablaPageRank(tablaPageRank);
+    return true;
+}
+
+// consulta OR ordenada por BM25 + pagerank (modo --bm25). en la cache se guardan los k ids ya
+// ordenados, y si es un hit se vuelven a puntuar solo esos k para mostrar los puntajes
+bool responderConsultaBM25(const string& consultaInput, const Segmento& segmento, const FiltroStopwords& stopwords,
+                           Cache& cache, int& inserciones, vector<ListaPostings>& listas, size_t k, ostream* salida) {
+    string claveCache = normalizarConsulta(consultaInput);
+    vector<int> resultados;
+    vector<DocPuntaje> ordenados;
+    obtenerListasConsulta(segmento, consultaInput, stopwords, listas);
+
+    bool hit = buscarCache(cache, claveCache, resultados);
+    if (hit) {
+        if (salida) *salida << "✅ HIT en caché\n";
+        puntuarBM25(segmento, listas, resultados, ordenados);
+    } else {
+        if (salida) *salida << "❌ MISS - buscando en índice\n";
+        topKBM25(segmento, listas, k, ordenados);
+        for (const DocPuntaje& doc : ordenados) resultados.push_back(doc.first);
+        if (insertarCache(cache, claveCache, resultados)) inserciones++;
+    }
+
+    if (salida) {
+        *salida << "Resultados con BM25 + PageRank: ";
+        for (auto& par : ordenados)
+            *salida << "[" << idOriginal(segmento, par.first) << " | " << fixed << setprecision(6) << par.second << "] ";
+        *salida << endl;
+    }
+    return hit;
+}
 
-        // normalizamos la consulta para usarla como clave en la cache
-        string claveCache = normalizarConsulta(consultaInput);
-        vector<int> resultados;
+// resuelve una consulta como en el bucle interactivo: primero la cache, si no esta se busca
+// en el indice (y se guarda en la cache), y despues se quedan los k con mas pagerank (0 = todos).
+// si salida no es nullptr escribe ahi lo mismo que se muestra por consola. devuelve true si fue un hit,
+// y si fue un miss suma 1 a inserciones solo si la cache se quedo con el resultado
+// con bm25 la consulta es OR y se ordena por BM25 + pagerank (responderConsultaBM25).
+// si el segmento esta numerado por pagerank solo se buscan los primeros k de la interseccion,
+// que ya son los de mas pagerank (y eso es lo que se guarda en la cache, k no cambia en una corrida).
+// los ids se muestran siempre como la linea del archivo
+bool responderConsulta(const string& consultaInput, const Segmento& segmento, const FiltroStopwords& stopwords,
+                       Cache& cache, int& inserciones, CacheIntersecciones& pares, vector<ListaPostings>& listas,
+                       size_t k, bool bm25, ostream* salida) {
+    if (bm25) return responderConsultaBM25(consultaInput, segmento, stopwords, cache, inserciones, listas, k, salida);
+
+    // normalizamos la consulta para usarla como clave en la cache
+    string claveCache = normalizarConsulta(consultaInput);
+    vector<int> resultados;
+
+    // buscamos en la cache primero
+    bool hit = buscarCache(cache, claveCache, resultados);
+    if (hit) {
+        // si esta es un hit
+        if (salida) *salida << "✅ HIT en caché\n";
+    } else {
+        // si no esta es un miss
+        if (salida) *salida << "❌ MISS - buscando en índice\n";
+        
+        // asi que tenemos que buscar en el indice principal
+        // usamos la misma logica de interseccion de antes
+        obtenerListasConsulta(segmento, consultaInput, stopwords, listas);
+        if (segmento.cabecera->ordenPageRank && k > 0) intersectarPrimeros(listas, k, resultados);
+        else intersectarListas(listas, resultados, pares);
+
+        // una vez que tenemos los resultados, los metemos a la cache
+        // si la cache ya estaba llena provoca un reemplazo (la cache los cuenta), y con TinyLFU
+        // puede que no se quede (tambien los cuenta)
+        if (insertarCache(cache, claveCache, resultados)) inserciones++;
+    }
+
+    // mostramos los resultados sin ordenar por importancia, con la linea del archivo de menor a mayor
+    // como siempre (si los docs se renumeraron, el orden de los ids ya no es ese). si solo se buscaron
+    // los primeros k no es la interseccion entera, asi que se dice
+    if (salida) {
+        vector<int> lineas;
+        lineas.reserve(resultados.size());
+        for (int id : resultados) lineas.push_back(idOriginal(segmento, id));
+        bool primeros = segmento.cabecera->ordenPageRank && k > 0;
+        if (primeros) *salida << "Primeros " << k << " resultados (por PageRank): ";
+        else {
+            if (!is_sorted(lineas.begin(), lineas.end())) sort(lineas.begin(), lineas.end());
+            *salida << "Resultados sin PageRank: ";
+        }
+        for (int linea : lineas) *salida << linea << " ";
+        *salida << endl;
+    }
+
+    // ahora nos quedamos con los k de mas pagerank (solo se muestra la primera pagina)
+    vector<DocPuntaje> ordenados;
+    topKPageRank(segmento, resultados, k, ordenados);
+
+    // y mostramos los resultados ordenados por importancia
+    if (salida) {
+        *salida << "Resultados con PageRank: ";
+        for (auto& par : ordenados)
+            *salida << "[" << idOriginal(segmento, par.first) << " | " << fixed << setprecision(6) << par.second << "] ";
+        *salida << endl;
+    }
+    return hit;
+}
+
+// el percentil p (0 a 1) de tiempos ya ordenados, el de la posicion ceil(p * n)
+double percentil(const vector<double>& ordenados, double p) {
+    if (ordenados.empty()) return 0.0;
+    size_t pos = static_cast<size_t>(ceil(p * ordenados.size()));
+    return ordenados[pos == 0 ? 0 : pos - 1];
+}
+
+// una fila de la tabla de latencias (en microsegundos)
+void mostrarLatencias(const string& nombre, vector<double>& tiempos) {
+    sort(tiempos.begin(), tiempos.end());
+    cout << setw(6) << left << nombre << right << setw(8) << tiempos.size() << fixed << setprecision(1)
+         << setw(10) << percentil(tiempos, 0.50) << setw(10) << percentil(tiempos, 0.95)
+         << setw(10) << percentil(tiempos, 0.99) << setw(10) << (tiempos.empty() ? 0.0 : tiempos.back()) << "\n";
+}
+
+// modo por lotes: en vez de leer de la consola, pasa todas las consultas de un archivo (una por linea)
+// por el mismo camino (cache -> indice -> pagerank) y mide cuanto tarda cada una.
+// los resultados no se muestran, o se escriben en archivoSalida si no esta vacio
+void modoLote(const string& archivoLote, const string& archivoSalida, const Segmento& segmento,
+              const FiltroStopwords& stopwords, Cache& cache, CacheIntersecciones& pares, size_t k, bool bm25,
+              int& hits, int& misses, int& inserciones) {
+    ifstream lote(archivoLote);
+    if (!lote.is_open()) {
+        cerr << "❌ Error: no se pudo abrir " << archivoLote << "\n";
+        return;
+    }
+    vector<string> consultas;
+    string linea;
+    while (getline(lote, linea)) {
+        if (!linea.empty()) consultas.push_back(linea);
+    }
+
+    ofstream archivo;
+    ostream* salida = nullptr;
+    if (!archivoSalida.empty()) {
+        archivo.open(archivoSalida);
+        if (archivo.is_open()) salida = &archivo;
+        else cerr << "❌ Error: no se pudo escribir " << archivoSalida << ", los resultados no se guardan\n";
+    }
+
+    vector<ListaPostings> listas;
+    vector<double> tiemposHit, tiemposMiss; // en microsegundos
+    high_resolution_clock::time_point inicioLote = high_resolution_clock::now();
+    for (const string& consulta : consultas) {
+        if (salida) *salida << "> " << consulta << "\n";
+        high_resolution_clock::time_point inicio = high_resolution_clock::now();
+        bool hit = responderConsulta(consulta, segmento, stopwords, cache, inserciones, pares, listas, k, bm25, salida);
+        double micros = duration<double, micro>(high_resolution_clock::now() - inicio).count();
+        if (hit) { hits++; tiemposHit.push_back(micros); }
+        else { misses++; tiemposMiss.push_back(micros); }
+    }
+    double tiempoLote = duration<double>(high_resolution_clock::now() - inicioLote).count();
+
+    cout << "\n--- Modo por lotes ---\n";
+    cout << "Consultas: " << consultas.size() << " en " << fixed << setprecision(3) << tiempoLote << " segundos ("
+         << setprecision(1) << (tiempoLote > 0 ? consultas.size() / tiempoLote : 0.0) << " consultas/s)\n";
+    cout << "Latencias en microsegundos:\n";
+    cout << "tipo  consultas       p50       p95       p99       max\n";
+    vector<double> todos(tiemposHit);
+    todos.insert(todos.end(), tiemposMiss.begin(), tiemposMiss.end());
+    mostrarLatencias("hit", tiemposHit);
+    mostrarLatencias("miss", tiemposMiss);
+    mostrarLatencias("todas", todos);
+}
+
+int main(int argc, char* argv[]) {
+    // revisamos que nos pasen los 3 archivos (y las opciones, si hay)
+    if (argc < 4) {
+        cout << "Uso: " << argv[0] << " <documentos.dat> <consultas.dat> <stopwords.txt> [--indice <archivo.idx>] [--threads N] [--cache lru|tinylfu] [--cache-bytes N] [--comprimir-cache] [--lote <consultas.txt> [--salida <archivo>]] [--k N] [--bm25] [--reordenar] [--pagerank-bits 64|32|16]\n";
+        return 1;
+    }
 
-        // buscamos en la cache primero
-        if (buscarCache(cache, claveCache, resultados)) {
-            // si esta es un hit
-            hits++;
-            cout << "✅ HIT en caché\n";
+    string archivoDocumentos = argv[1];
+    string archivoConsultas = argv[2];
+    string archivoStopwords = argv[3];
+    string archivoIndice; // si se pasa, el indice se guarda ahi y las proximas veces se abre de ahi
+    int numHilos = 1;     // hilos para construir el indice y calcular el pagerank
+    PoliticaCache politica = POLITICA_LRU; // a quien saca la cache cuando se llena
+    size_t bytesCache = 0;                 // si no es 0, la cache se limita por bytes y no por cantidad
+    bool comprimirCache = false;
+    string archivoLote;   // si se pasa, se responden las consultas de ese archivo en vez de las de la consola
+    string archivoSalida; // y los resultados van ahi (si no, no se muestran)
+    size_t k = 10;        // cuantos resultados con pagerank se muestran (0 = todos)
+    bool bm25 = false;    // consultas OR ordenadas por BM25 + pagerank en vez de AND por pagerank
+    bool reordenar = false; // numerar los docs por pagerank al armar el indice
+    int bitsPageRank = 64;  // cuanto ocupa el pagerank de cada doc en el indice
+    for (int i = 4; i < argc; ++i) {
+        string opcion = argv[i];
+        if (opcion == "--indice" && i + 1 < argc) {
+            archivoIndice = argv[++i];
+        } else if (opcion == "--threads" && i + 1 < argc) {
+            numHilos = max(1, atoi(argv[++i]));
+        } else if (opcion == "--cache" && i + 1 < argc && leerPolitica(argv[i + 1], politica)) {
+            ++i;
+        } else if (opcion == "--cache-bytes" && i + 1 < argc) {
+            bytesCache = strtoull(argv[++i], nullptr, 10);
+        } else if (opcion == "--comprimir-cache") {
+            comprimirCache = true;
+        } else if (opcion == "--lote" && i + 1 < argc) {
+            archivoLote = argv[++i];
+        } else if (opcion == "--salida" && i + 1 < argc) {
+            archivoSalida = argv[++i];
+        } else if (opcion == "--k" && i + 1 < argc) {
+            k = strtoull(argv[++i], nullptr, 10);
+        } else if (opcion == "--bm25") {
+            bm25 = true;
+        } else if (opcion == "--reordenar") {
+            reordenar = true;
+        } else if (opcion == "--pagerank-bits" && i + 1 < argc &&
+                   (string(argv[i + 1]) == "64" || string(argv[i + 1]) == "32" || string(argv[i + 1]) == "16")) {
+            bitsPageRank = atoi(argv[++i]);
         } else {
-            // si no esta es un miss
-            misses++;
-            cout << "❌ MISS - buscando en índice\n";
-            
-            // asi que tenemos que buscar en el indice principal
-            istringstream iss(consultaInput);
-            string palabra;
-            vector<NodoDoc*> listas;
-            while (iss >> palabra) {
-                string limpia = limpiarPalabra(palabra);
-                if (!limpia.empty() && !esStopword(limpia, stopwords)) {
-                    NodoTermino* nodo = buscarTermino(indice, limpia);
-                    if (nodo) listas.push_back(nodo->listaDocumentos);
-                }
-            }
-
-            // usamos la misma logica de interseccion de antes
-            set<int> resultadoSet;
-            if (!listas.empty() && listas[0]) {
-                NodoDoc* base = listas[0];
-                while (base) {
-                    bool comun = true;
-                    for (size_t j = 1; j < listas.size(); ++j) {
-                        NodoDoc* aux = listas[j];
-                        bool encontrado = false;
-                        while (aux) {
-                            if (aux->idDocumento == base->idDocumento) {
-                                encontrado = true; break;
-                            }
-                            aux = aux->siguiente;
-                        }
-                        if (!encontrado) { comun = false; break; }
-                    }
-                    if (comun) resultadoSet.insert(base->idDocumento);
-                    base = base->siguiente;
-                }
-            }
-
-            // una vez que tenemos los resultados, los metemos a la cache
-            resultados.assign(resultadoSet.begin(), resultadoSet.end());
-            // si la cache ya estaba llena provoca un reemplazo
-            if (cache.size >= cache.capacidad) reemplazos++;
-            insertarCache(cache, claveCache, resultados);
-            inserciones++;
+            cout << "Opcion desconocida: " << opcion << "\n";
+            return 1;
         }
+    }
 
-        // mostramos los resultados tal como vienen del indice
-        cout << "Resultados sin PageRank: ";
-        for (int id : resultados) cout << id << " ";
-        cout << endl;
+    // tamaño y fecha de los tres archivos de entrada, tomados antes de leer nada: si alguno
+    // cambia mientras se arma el indice, la proxima vez no coincide y se vuelve a armar
+    FirmasSegmento firmas;
+    firmas.documentos = firmaArchivo(archivoDocumentos);
+    firmas.consultas = firmaArchivo(archivoConsultas);
+    firmas.stopwords = firmaArchivo(archivoStopwords);
+    FiltroStopwords stopwords;
+    cargarStopwords(archivoStopwords, stopwords); //cargamos las stopwords para ignorarlas
 
-        // ahora buscamos el score de pagerank para cada resultado y lo ordenamos
-        vector<pair<int, double>> ordenados;
-        for (int id : resultados)
-            ordenados.emplace_back(id, obtenerScorePageRank(grafo, id));
+    // si ya hay un indice guardado para estos mismos archivos lo abrimos con mmap y nos saltamos
+    // toda la fase offline. si no, lo construimos y (si nos dieron el archivo) lo guardamos
+    Segmento segmento;
+    bool cargado = false;
+    if (!archivoIndice.empty() && abrirSegmento(archivoIndice, segmento)) {
+        if (mismasFirmas(segmento.cabecera->firmas, firmas) &&
+            segmento.cabecera->ordenPageRank == static_cast<unsigned int>(reordenar) &&
+            segmento.cabecera->bytesPageRank * 8 == static_cast<unsigned int>(bitsPageRank)) {
+            cargado = true;
+            cout << "📂 Índice cargado desde " << archivoIndice << " (" << segmento.cabecera->numDocs
+                 << " documentos, " << segmento.cabecera->numTerminos << " términos)\n";
+        } else {
+            cout << "⚠️  El índice guardado no corresponde a estos archivos (o a las opciones del indice), se vuelve a construir.\n";
+            cerrarSegmento(segmento);
+        }
+    }
+    if (!cargado) {
+        if (!faseOffline(archivoDocumentos, archivoConsultas, stopwords, numHilos, reordenar, bitsPageRank, firmas, segmento))
+            return 1; // sin documentos no hay nada que buscar
+        if (!archivoIndice.empty()) {
+            if (escribirSegmento(segmento, archivoIndice))
+                cout << "💾 Índice guardado en " << archivoIndice << "\n";
+            else
+                cerr << "❌ Error: no se pudo guardar el índice en " << archivoIndice << "\n";
+        }
+    }
 
-        sort(ordenados.begin(), ordenados.end(),
-             [](auto& a, auto& b) { return a.second > b.second; });
+    // bucle Interactivo con Cache (Logica del P3) 
+    Cache cache;
+    inicializarCache(cache, 10, 53, politica); // inicializamos nuestra cache con capacidad 10
+    if (bytesCache > 0 || comprimirCache) limitarBytesCache(cache, bytesCache, comprimirCache);
+    int hits = 0, misses = 0, inserciones = 0; // variables para contar las metricas
+    // y la de pares de terminos ya intersectados, para los miss que comparten palabras con otra consulta
+    CacheIntersecciones pares;
+    inicializarCacheIntersecciones(pares, 4 << 20); // 4 MB
 
-        // y mostramos los resultados ordenados por importancia
-        cout << "Resultados con PageRank: ";
-        for (auto& par : ordenados)
-            cout << "[" << par.first << " | " << fixed << setprecision(6) << par.second << "] ";
-        cout << endl;
+    string consultaInput;
+    vector<ListaPostings> listas; // se reusa entre consultas
+    if (!archivoLote.empty()) {
+        modoLote(archivoLote, archivoSalida, segmento, stopwords, cache, pares, k, bm25, hits, misses, inserciones);
+    } else {
+        cout << "\n✅ Sistema listo. Ingrese su consulta." << endl;
+    }
+
+    // el bucle principal, se ejecuta hasta que el usuario escriba "exit"
+    while (archivoLote.empty()) {
+        cout << "\n> ";
+        getline(cin, consultaInput);
+        if (consultaInput == "exit") break;
+
+        bool hit = responderConsulta(consultaInput, segmento, stopwords, cache, inserciones, pares, listas, k, bm25, &cout);
+        if (hit) hits++;
+        else misses++;
 
         // tambien mostramos como quedo la cache para ver el orden LRU
         mostrarEstadoCache(cache);
@@ -286,19 +464,27 @@ int main(int argc, char* argv[]) {
     double tasaFallos   = (totalConsultas == 0 ? 0 : (misses * 100.0 / totalConsultas));
 
     cout << "\n--- Métricas Finales de la Sesión ---\n";
+    cout << "Política de caché: " << nombrePolitica(politica) << "\n";
     cout << "Total consultas: " << totalConsultas << "\n";
     cout << "Hits: " << hits << "\n";
     cout << "Misses: " << misses << "\n";
     cout << "Tasa aciertos: " << fixed << setprecision(2) << tasaAciertos << "%\n";
     cout << "Tasa fallos: " << fixed << setprecision(2) << tasaFallos << "%\n";
-    cout << "Reemplazos: " << reemplazos << "\n";
+    cout << "Reemplazos: " << cache.expulsados << "\n";
+    cout << "Rechazados por la caché: " << cache.rechazados << "\n";
     cout << "Inserciones en caché: " << inserciones << "\n";
     cout << "Elementos actuales en caché: " << cache.size << "\n";
+    cout << "Memoria usada por la caché: " << cache.bytesUsados << " bytes";
+    if (cache.bytesMaximos > 0) cout << " (de " << cache.bytesMaximos << ")";
+    cout << "\n";
+    cout << "Caché de pares: " << pares.aciertos << " aciertos en " << pares.consultas
+         << " consultas de 2+ términos, " << pares.postingsAhorrados << " de " << pares.postingsTotales
+         << " postings sin recorrer (" << pares.cache.bytesUsados << " bytes)\n";
 
     // liberar toda la memoria que pedimos
     liberarCache(cache);
-    liberarIndice(indice);
-    liberarGrafo(grafo);
+    liberarCacheIntersecciones(pares);
+    cerrarSegmento(segmento);
     
     return 0;
 }
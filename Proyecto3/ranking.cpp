@@ -0,0 +1,247 @@
+#include "ranking.h"
+#include <algorithm>
+#include <cmath>
+#include <climits>
+
+bool mejorResultado(const DocPuntaje& a, const DocPuntaje& b) {
+    if (a.second != b.second) return a.second > b.second;
+    return a.first < b.first;
+}
+
+void topKPageRank(const Segmento& segmento, const std::vector<int>& resultados, size_t k,
+                  std::vector<DocPuntaje>& top) {
+    top.clear();
+    if (k == 0 || k > resultados.size()) k = resultados.size();
+    top.reserve(k);
+    for (int id : resultados) {
+        DocPuntaje actual(id, pageRankTabla(segmento.pageRank, id));
+        if (top.size() < k) {
+            top.push_back(actual);
+            std::push_heap(top.begin(), top.end(), mejorResultado);
+        } else if (mejorResultado(actual, top.front())) {
+            // le gana al peor de los k: lo sacamos y entra este
+            std::pop_heap(top.begin(), top.end(), mejorResultado);
+            top.back() = actual;
+            std::push_heap(top.begin(), top.end(), mejorResultado);
+        }
+    }
+    // con mejorResultado como "menor", sort_heap deja el mejor primero
+    std::sort_heap(top.begin(), top.end(), mejorResultado);
+}
+
+void ordenPorPageRank(const TablaPageRank& tabla, int numDocs, std::vector<int>& nuevoId) {
+    std::vector<DocPuntaje> docs;
+    docs.reserve(numDocs);
+    for (int id = 1; id <= numDocs; ++id) docs.emplace_back(id, pageRankTabla(tabla, id));
+    std::sort(docs.begin(), docs.end(), mejorResultado);
+    nuevoId.assign(numDocs + 1, 0);
+    for (int i = 0; i < numDocs; ++i) nuevoId[docs[i].first] = i + 1;
+}
+
+double idfBM25(int numDocs, int df) {
+    // la version que nunca da negativo aunque el termino salga en mas de la mitad de los docs
+    return std::log(1.0 + (numDocs - df + 0.5) / (df + 0.5));
+}
+
+double puntajeBM25(int frecuencia, int largo, double largoPromedio, double idf) {
+    double normalizado = largoPromedio > 0 ? largo / largoPromedio : 1.0;
+    return idf * frecuencia * (K1_BM25 + 1) / (frecuencia + K1_BM25 * (1 - B_BM25 + B_BM25 * normalizado));
+}
+
+double priorPageRank(double pageRank, int numDocs) {
+    return PESO_PAGERANK * std::log1p(numDocs * pageRank);
+}
+
+// mete un doc al heap de los k mejores (arriba el peor), si le gana al peor o si todavia hay lugar
+void agregarTopK(std::vector<DocPuntaje>& top, size_t k, const DocPuntaje& actual) {
+    if (k == 0 || top.size() < k) {
+        top.push_back(actual);
+        std::push_heap(top.begin(), top.end(), mejorResultado);
+    } else if (mejorResultado(actual, top.front())) {
+        std::pop_heap(top.begin(), top.end(), mejorResultado);
+        top.back() = actual;
+        std::push_heap(top.begin(), top.end(), mejorResultado);
+    }
+}
+
+// por donde va cada lista: el bloque descomprimido y el doc actual
+struct CursorBM25 {
+    const ListaPostings* lista;
+    double idf;
+    int bloque;                     // el bloque donde esta el doc actual
+    int cargado;                    // el bloque que esta en ids/frecuencias (-1 ninguno)
+    int cuantos;                    // cuantos docs tiene ese bloque
+    int pos;                        // donde esta el doc actual dentro del bloque
+    int doc;                        // el doc actual (INT_MAX si la lista se termino)
+    int ids[TAM_BLOQUE];
+    int frecuencias[TAM_BLOQUE];
+};
+
+void iniciarCursor(CursorBM25& cursor, const ListaPostings& lista, int numDocs) {
+    cursor.lista = &lista;
+    cursor.idf = idfBM25(numDocs, lista.numDocs);
+    cursor.bloque = 0;
+    cursor.cargado = -1;
+    cursor.cuantos = 0;
+    cursor.pos = 0;
+    cursor.doc = -1;
+}
+
+// el primer bloque desde el actual que termina en objetivo o despues (numBloques si no hay)
+int bloqueHasta(const CursorBM25& cursor, int objetivo) {
+    const ListaPostings& lista = *cursor.lista;
+    int b = cursor.bloque;
+    if (b < lista.numBloques && lista.saltos[b].ultimoId < objetivo) {
+        b = std::lower_bound(lista.saltos + b, lista.saltos + lista.numBloques, objetivo,
+                             [](const SaltoBloque& salto, int id) { return salto.ultimoId < id; })
+            - lista.saltos;
+    }
+    return b;
+}
+
+// mueve el cursor al primer doc >= objetivo (descomprime solo el bloque donde cae)
+void avanzarCursor(CursorBM25& cursor, int objetivo) {
+    if (cursor.doc >= objetivo) return;
+    int b = bloqueHasta(cursor, objetivo);
+    if (b >= cursor.lista->numBloques) {
+        cursor.doc = INT_MAX;
+        return;
+    }
+    if (cursor.cargado != b) {
+        cursor.cuantos = decodificarBloque(*cursor.lista, b, cursor.ids, cursor.frecuencias);
+        cursor.cargado = b;
+        cursor.pos = 0;
+    }
+    cursor.bloque = b;
+    // casi siempre se avanza al doc siguiente o a uno cerca: primero miramos unos pocos de a uno
+    int pos = cursor.pos, hasta = std::min(cursor.pos + 8, cursor.cuantos);
+    while (pos < hasta && cursor.ids[pos] < objetivo) pos++;
+    if (pos == hasta && pos < cursor.cuantos)
+        pos = std::lower_bound(cursor.ids + pos, cursor.ids + cursor.cuantos, objetivo) - cursor.ids;
+    cursor.pos = pos;
+    cursor.doc = cursor.ids[cursor.pos]; // el bloque termina en objetivo o despues, asi que hay uno
+}
+
+// el puntaje de un doc en el que estan parados algunos cursores: los terminos se suman en el orden
+// de las listas y despues el pagerank, asi da exactamente lo mismo que topKBM25Exhaustivo
+double puntajeDoc(const Segmento& segmento, const std::vector<CursorBM25>& cursores, int doc) {
+    double suma = 0.0;
+    for (const CursorBM25& cursor : cursores) {
+        if (cursor.doc == doc)
+            suma += puntajeBM25(cursor.frecuencias[cursor.pos], segmento.largos[doc],
+                                segmento.cabecera->largoPromedio, cursor.idf);
+    }
+    return suma + priorPageRank(pageRankTabla(segmento.pageRank, doc), segmento.cabecera->numDocs);
+}
+
+long long topKBM25(const Segmento& segmento, const std::vector<ListaPostings>& listas, size_t k,
+                   std::vector<DocPuntaje>& top) {
+    // si se piden todos no hay nada que podar, y sumar lista por lista es mas barato
+    if (k == 0) return topKBM25Exhaustivo(segmento, listas, k, top);
+    top.clear();
+    int numDocs = segmento.cabecera->numDocs;
+    std::vector<CursorBM25> cursores(listas.size());
+    std::vector<int> orden(listas.size()); // los cursores ordenados por doc actual
+    for (size_t i = 0; i < listas.size(); ++i) {
+        iniciarCursor(cursores[i], listas[i], numDocs);
+        avanzarCursor(cursores[i], 0);
+        orden[i] = static_cast<int>(i);
+    }
+
+    long long puntuados = 0;
+    while (true) {
+        // pocas listas (una por palabra), asi que alcanza con insercion
+        for (size_t i = 1; i < orden.size(); ++i)
+            for (size_t j = i; j > 0 && cursores[orden[j]].doc < cursores[orden[j - 1]].doc; --j)
+                std::swap(orden[j], orden[j - 1]);
+
+        // el puntaje a superar: el peor de los k (si todavia no hay k, cualquiera entra)
+        double umbral = (k != 0 && top.size() == k) ? top.front().second : -INFINITY;
+
+        // el pivote: el primer cursor donde la suma de los maximos (mas el mayor pagerank de esas
+        // listas, que un doc lo cuenta una sola vez) llega al umbral. ningun doc antes del suyo puede entrar
+        size_t pivote = orden.size();
+        double acumulado = 0.0, prior = 0.0;
+        for (size_t i = 0; i < orden.size() && cursores[orden[i]].doc != INT_MAX; ++i) {
+            acumulado += cursores[orden[i]].lista->maxPuntaje;
+            prior = std::max(prior, static_cast<double>(cursores[orden[i]].lista->maxPrior));
+            if (acumulado + prior >= umbral) { pivote = i; break; }
+        }
+        if (pivote == orden.size()) break; // no queda ningun doc que pueda entrar
+        int docPivote = cursores[orden[pivote]].doc;
+        // los que estan en el mismo doc tambien cuentan para el
+        while (pivote + 1 < orden.size() && cursores[orden[pivote + 1]].doc == docPivote) pivote++;
+
+        // ahora con los maximos de los bloques donde cae el pivote. si tampoco alcanzan, ningun doc
+        // hasta el final del primero de esos bloques puede entrar (ni hasta el doc del siguiente cursor)
+        double maximoBloques = 0.0, priorBloques = 0.0;
+        int siguiente = pivote + 1 < orden.size() ? cursores[orden[pivote + 1]].doc : INT_MAX;
+        for (size_t i = 0; i <= pivote; ++i) {
+            const CursorBM25& cursor = cursores[orden[i]];
+            int b = bloqueHasta(cursor, docPivote);
+            if (b >= cursor.lista->numBloques) continue;
+            const SaltoBloque& salto = cursor.lista->saltos[b];
+            if (docPivote < salto.primerId) {
+                // el pivote cae entre dos bloques: esta lista no aporta hasta que empiece el siguiente
+                siguiente = std::min(siguiente, salto.primerId);
+            } else {
+                maximoBloques += cursor.lista->maximos[b];
+                priorBloques = std::max(priorBloques, static_cast<double>(cursor.lista->maximosPrior[b]));
+                if (salto.ultimoId < INT_MAX) siguiente = std::min(siguiente, salto.ultimoId + 1);
+            }
+        }
+        if (maximoBloques + priorBloques < umbral) {
+            for (size_t i = 0; i <= pivote; ++i) avanzarCursor(cursores[orden[i]], siguiente);
+            continue;
+        }
+
+        if (cursores[orden[0]].doc == docPivote) {
+            // todos los de antes del pivote estan en su doc: lo puntuamos entero
+            agregarTopK(top, k, DocPuntaje(docPivote, puntajeDoc(segmento, cursores, docPivote)));
+            puntuados++;
+            for (size_t i = 0; i <= pivote; ++i) avanzarCursor(cursores[orden[i]], docPivote + 1);
+        } else {
+            // los docs antes del pivote no pueden entrar, los de atras saltan hasta el
+            for (size_t i = 0; i < pivote; ++i) avanzarCursor(cursores[orden[i]], docPivote);
+        }
+    }
+    std::sort_heap(top.begin(), top.end(), mejorResultado);
+    return puntuados;
+}
+
+long long topKBM25Exhaustivo(const Segmento& segmento, const std::vector<ListaPostings>& listas, size_t k,
+                             std::vector<DocPuntaje>& top) {
+    top.clear();
+    int numDocs = segmento.cabecera->numDocs;
+    // la suma de cada doc, lista por lista (en el mismo orden que puntajeDoc)
+    std::vector<double> sumas(numDocs + 1, 0.0);
+    std::vector<char> visto(numDocs + 1, 0);
+    std::vector<int> ids, frecuencias, docs;
+    for (const ListaPostings& lista : listas) {
+        double idf = idfBM25(numDocs, lista.numDocs);
+        descomprimirLista(lista, ids, &frecuencias);
+        for (size_t i = 0; i < ids.size(); ++i) {
+            int doc = ids[i];
+            sumas[doc] += puntajeBM25(frecuencias[i], segmento.largos[doc], segmento.cabecera->largoPromedio, idf);
+            if (!visto[doc]) { visto[doc] = 1; docs.push_back(doc); }
+        }
+    }
+    for (int doc : docs)
+        agregarTopK(top, k, DocPuntaje(doc, sumas[doc] + priorPageRank(pageRankTabla(segmento.pageRank, doc), numDocs)));
+    std::sort_heap(top.begin(), top.end(), mejorResultado);
+    return static_cast<long long>(docs.size());
+}
+
+void puntuarBM25(const Segmento& segmento, const std::vector<ListaPostings>& listas,
+                 const std::vector<int>& ids, std::vector<DocPuntaje>& puntuados) {
+    puntuados.clear();
+    std::vector<int> ordenados(ids);
+    std::sort(ordenados.begin(), ordenados.end());
+    std::vector<CursorBM25> cursores(listas.size());
+    for (size_t i = 0; i < listas.size(); ++i) iniciarCursor(cursores[i], listas[i], segmento.cabecera->numDocs);
+    for (int doc : ordenados) {
+        for (CursorBM25& cursor : cursores) avanzarCursor(cursor, doc);
+        puntuados.emplace_back(doc, puntajeDoc(segmento, cursores, doc));
+    }
+    std::sort(puntuados.begin(), puntuados.end(), mejorResultado);
+}
@@ -0,0 +1,58 @@
+#ifndef RANKING_H
+#define RANKING_H
+
+#include <vector>
+#include <utility>
+#include "segmento.h"
+
+// para que no se incluya dos veces
+// aqui va todo lo de ordenar los resultados de una consulta
+
+// un resultado ya puntuado: (id del doc, puntaje)
+typedef std::pair<int, double> DocPuntaje;
+
+// true si a va antes que b: mas puntaje primero, y si empatan el id mas chico
+// (asi el orden no depende de como llegaron los resultados)
+bool mejorResultado(const DocPuntaje& a, const DocPuntaje& b);
+
+// los k resultados con mas pagerank, ordenados del mejor al peor (k = 0 es todos).
+// en vez de ordenar todos los resultados se mantiene un heap con los k mejores vistos hasta ahora
+// (arriba el peor de ellos), asi cuesta O(resultados * log k). el pagerank se lee directo de la
+// tabla del segmento (uno por id), sin buscar el doc en el grafo
+void topKPageRank(const Segmento& segmento, const std::vector<int>& resultados, size_t k,
+                  std::vector<DocPuntaje>& top);
+
+// el id nuevo de cada doc si se numeran de mayor a menor pagerank (los empates por id, igual que
+// mejorResultado), para renumerarIndice. nuevoId[0] = 0 y los demas van de 1 a numDocs
+void ordenPorPageRank(const TablaPageRank& tabla, int numDocs, std::vector<int>& nuevoId);
+
+// BM25: cuanto aporta un termino a un doc segun cuantas veces sale (frecuencia), que tan largo
+// es el doc comparado con el promedio, y que tan raro es el termino (idf)
+const double K1_BM25 = 1.2;         // cuanto pesa repetir el termino (se satura)
+const double B_BM25 = 0.75;         // cuanto se castiga a los docs largos
+// el pagerank entra como un puntaje mas: PESO_PAGERANK * log(1 + numDocs * pagerank)
+// (numDocs * pagerank es 1 para un doc promedio, asi no depende del tamaño de la coleccion)
+const double PESO_PAGERANK = 1.0;
+
+double idfBM25(int numDocs, int df);
+double puntajeBM25(int frecuencia, int largo, double largoPromedio, double idf);
+double priorPageRank(double pageRank, int numDocs);
+
+// consultas OR: los k docs (0 = todos) con mas BM25 (sumando los terminos que tienen) + pagerank,
+// ordenados del mejor al peor. las listas tienen que venir del segmento (obtenerListasConsulta),
+// que trae el BM25 maximo de cada lista y de cada bloque. con eso se hace block-max WAND: se
+// recorren las listas juntas por id y un doc solo se puntua si la suma de los maximos de sus
+// terminos (mas el mayor pagerank de esas listas) puede superar al peor de los k que ya tenemos;
+// si ni los maximos de los bloques alcanzan se salta hasta que termine alguno de esos bloques,
+// sin descomprimir nada.
+// devuelve cuantos docs se puntuaron enteros
+long long topKBM25(const Segmento& segmento, const std::vector<ListaPostings>& listas, size_t k,
+                   std::vector<DocPuntaje>& top);
+// lo mismo puntuando todos los docs de todas las listas, para comparar
+long long topKBM25Exhaustivo(const Segmento& segmento, const std::vector<ListaPostings>& listas, size_t k,
+                             std::vector<DocPuntaje>& top);
+// el puntaje de unos docs ya elegidos (por ejemplo los de la cache), ordenados del mejor al peor
+void puntuarBM25(const Segmento& segmento, const std::vector<ListaPostings>& listas,
+                 const std::vector<int>& ids, std::vector<DocPuntaje>& puntuados);
+
+#endif // RANKING_H
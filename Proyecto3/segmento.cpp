@@ -0,0 +1,365 @@
+#include "segmento.h"
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+#include "ranking.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+// redondea hacia arriba a multiplo de 8, para que cada seccion quede alineada
+unsigned long long alinear8(unsigned long long x) {
+    return (x + 7) & ~7ULL;
+}
+
+// las secciones grandes que se leen por id van alineadas a una linea de cache
+unsigned long long alinear64(unsigned long long x) {
+    return (x + 63) & ~63ULL;
+}
+
+// deja todos los punteros del segmento apuntando a sus secciones
+void apuntarSecciones(Segmento& segmento) {
+    const CabeceraSegmento* c = reinterpret_cast<const CabeceraSegmento*>(segmento.base);
+    segmento.cabecera = c;
+    segmento.tabla = reinterpret_cast<const unsigned int*>(segmento.base + c->offsetTabla);
+    segmento.terminos = reinterpret_cast<const EntradaTermino*>(segmento.base + c->offsetTerminos);
+    segmento.texto = segmento.base + c->offsetTexto;
+    segmento.saltos = reinterpret_cast<const SaltoBloque*>(segmento.base + c->offsetSaltos);
+    segmento.datos = reinterpret_cast<const unsigned char*>(segmento.base + c->offsetDatos);
+    segmento.largos = reinterpret_cast<const int*>(segmento.base + c->offsetLargos);
+    vistaTablaPageRank(segmento.base + c->offsetPageRank, c->numDocs, static_cast<int>(c->bytesPageRank),
+                       c->escalaPageRank, segmento.pageRank);
+    segmento.idsOriginales = reinterpret_cast<const int*>(segmento.base + c->offsetIdsOriginales);
+    segmento.maximos = reinterpret_cast<const float*>(segmento.base + c->offsetMaximos);
+    segmento.maximosPrior = reinterpret_cast<const float*>(segmento.base + c->offsetMaximosPrior);
+}
+
+// FNV-1a de 64 bits de toda la cabecera, con la suma en 0 (el relleno entre campos tambien
+// queda en 0 porque la cabecera se arma con memset)
+unsigned long long sumaCabecera(const CabeceraSegmento& cabecera) {
+    CabeceraSegmento c = cabecera;
+    c.sumaCabecera = 0;
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&c);
+    unsigned long long hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < sizeof(c); ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// el float mas chico que no es menor que x, asi el maximo guardado nunca queda por debajo del real
+float redondearArriba(double x) {
+    float f = static_cast<float>(x);
+    if (static_cast<double>(f) < x) f = std::nextafter(f, INFINITY);
+    return f;
+}
+
+// armamos todo el segmento en un vector de bytes
+void construirSegmento(const IndiceInvertido& indice, const TablaPageRank& tablaPageRank,
+                       const FirmasSegmento& firmas, Segmento& segmento) {
+    // primero contamos cuanto ocupa cada seccion
+    unsigned long long bytesTexto = 0, numSaltos = 0, bytesDatos = 0;
+    for (NodoTermino* t = indice.inicio; t != nullptr; t = t->siguiente) {
+        bytesTexto += t->termino.size();
+        numSaltos += t->listaDocumentos.numBloques;
+        bytesDatos += t->postings.datos.size();
+    }
+    // la tabla con por lo menos el doble de huecos que terminos, asi el sondeo es corto
+    unsigned int capacidad = 1;
+    while (capacidad < 2u * static_cast<unsigned int>(indice.numTerminos) + 1) capacidad *= 2;
+    int numDocs = indice.numDocs;
+
+    CabeceraSegmento c;
+    std::memset(&c, 0, sizeof(c));
+    std::memcpy(c.magia, MAGIA_SEGMENTO, sizeof(c.magia));
+    c.version = VERSION_SEGMENTO;
+    c.numDocs = numDocs;
+    c.numTerminos = indice.numTerminos;
+    c.capacidadTabla = capacidad;
+    c.firmas = firmas;
+    c.offsetTabla = alinear8(sizeof(CabeceraSegmento));
+    c.offsetTerminos = alinear8(c.offsetTabla + capacidad * sizeof(unsigned int));
+    c.offsetTexto = alinear8(c.offsetTerminos + indice.numTerminos * sizeof(EntradaTermino));
+    c.offsetSaltos = alinear8(c.offsetTexto + bytesTexto);
+    c.offsetDatos = alinear8(c.offsetSaltos + numSaltos * sizeof(SaltoBloque));
+    c.offsetLargos = alinear8(c.offsetDatos + bytesDatos);
+    c.bytesPageRank = static_cast<unsigned int>(tablaPageRank.bytesPorDoc);
+    c.escalaPageRank = tablaPageRank.escala;
+    c.offsetPageRank = alinear64(c.offsetLargos + (numDocs + 1) * sizeof(int));
+    c.offsetIdsOriginales = alinear8(c.offsetPageRank + (numDocs + 1) * static_cast<unsigned long long>(c.bytesPageRank));
+    c.offsetMaximos = alinear8(c.offsetIdsOriginales + (numDocs + 1) * sizeof(int));
+    c.offsetMaximosPrior = alinear8(c.offsetMaximos + numSaltos * sizeof(float));
+    c.tamTotal = c.offsetMaximosPrior + numSaltos * sizeof(float);
+
+    // el largo promedio de los docs (los ids van de 1 a numDocs), para BM25
+    double sumaLargos = 0.0;
+    for (int id = 1; id <= numDocs && id < static_cast<int>(indice.largoDocumentos.size()); ++id)
+        sumaLargos += indice.largoDocumentos[id];
+    c.largoPromedio = numDocs > 0 ? sumaLargos / numDocs : 0.0;
+
+    // si el indice se renumero y el pagerank quedo de mayor a menor, los primeros k docs de una
+    // interseccion son los k de mas pagerank y las consultas pueden cortar ahi
+    c.ordenPageRank = !indice.idsOriginales.empty();
+    for (int id = 2; id <= numDocs && c.ordenPageRank; ++id)
+        if (pageRankTabla(tablaPageRank, id) > pageRankTabla(tablaPageRank, id - 1)) c.ordenPageRank = 0;
+
+    c.sumaCabecera = sumaCabecera(c);
+
+    // alineado a 64 bytes (mmap lo alinea a pagina), asi la tabla de pagerank queda alineada igual
+    // que en el archivo. aligned_alloc pide un multiplo del alineamiento
+    size_t bytes = (c.tamTotal + 63) & ~static_cast<size_t>(63);
+    char* base = static_cast<char*>(std::aligned_alloc(64, bytes));
+    if (base == nullptr) throw std::bad_alloc();
+    std::memset(base, 0, bytes);
+    segmento.memoria = base;
+    std::memcpy(base, &c, sizeof(c));
+    segmento.base = base;
+    segmento.tam = c.tamTotal;
+    segmento.mapeado = false;
+
+    unsigned int* tabla = reinterpret_cast<unsigned int*>(base + c.offsetTabla);
+    EntradaTermino* terminos = reinterpret_cast<EntradaTermino*>(base + c.offsetTerminos);
+    SaltoBloque* saltos = reinterpret_cast<SaltoBloque*>(base + c.offsetSaltos);
+    float* maximos = reinterpret_cast<float*>(base + c.offsetMaximos);
+    float* maximosPrior = reinterpret_cast<float*>(base + c.offsetMaximosPrior);
+    int ids[TAM_BLOQUE], frecuencias[TAM_BLOQUE];
+
+    // copiamos cada termino: su palabra, sus saltos y sus bloques, y lo metemos en la tabla
+    unsigned long long texto = 0, salto = 0, datos = 0;
+    unsigned int numero = 0;
+    for (NodoTermino* t = indice.inicio; t != nullptr; t = t->siguiente, ++numero) {
+        EntradaTermino& e = terminos[numero];
+        const ListaPostings& lista = t->listaDocumentos;
+        e.hash = t->hash;
+        e.largoTexto = static_cast<unsigned int>(t->termino.size());
+        e.offsetTexto = texto;
+        e.primerSalto = salto;
+        e.offsetDatos = datos;
+        e.numDocs = lista.numDocs;
+        e.numBloques = lista.numBloques;
+
+        // el BM25 maximo y el mayor aporte del pagerank de cada bloque: hay que descomprimirlo
+        // una vez para ver frecuencias, largos y pagerank de sus docs
+        double idf = idfBM25(numDocs, lista.numDocs);
+        double maximoTermino = 0.0, maxPriorTermino = 0.0;
+        for (int b = 0; b < lista.numBloques; ++b) {
+            int cuantos = decodificarBloque(lista, b, ids, frecuencias);
+            double maximo = 0.0, maxPrior = 0.0;
+            for (int i = 0; i < cuantos; ++i) {
+                int id = ids[i];
+                int largo = id < static_cast<int>(indice.largoDocumentos.size()) ? indice.largoDocumentos[id] : 0;
+                double pr = pageRankTabla(tablaPageRank, id);
+                maximo = std::max(maximo, puntajeBM25(frecuencias[i], largo, c.largoPromedio, idf));
+                maxPrior = std::max(maxPrior, priorPageRank(pr, numDocs));
+            }
+            maximos[salto + b] = redondearArriba(maximo);
+            maximosPrior[salto + b] = redondearArriba(maxPrior);
+            maximoTermino = std::max(maximoTermino, maximo);
+            maxPriorTermino = std::max(maxPriorTermino, maxPrior);
+        }
+        e.maxPuntaje = redondearArriba(maximoTermino);
+        e.maxPrior = redondearArriba(maxPriorTermino);
+
+        std::memcpy(base + c.offsetTexto + texto, t->termino.data(), t->termino.size());
+        std::memcpy(saltos + salto, lista.saltos, lista.numBloques * sizeof(SaltoBloque));
+        std::memcpy(base + c.offsetDatos + datos, t->postings.datos.data(), t->postings.datos.size());
+        texto += t->termino.size();
+        salto += lista.numBloques;
+        datos += t->postings.datos.size();
+
+        unsigned int pos = e.hash & (capacidad - 1);
+        while (tabla[pos] != 0) pos = (pos + 1) & (capacidad - 1);
+        tabla[pos] = numero + 1;
+    }
+
+    // la tabla de documentos y el id original, uno por id, y la tabla de pagerank tal cual
+    // (si tiene menos docs que el indice, los que faltan quedan en 0)
+    int* largos = reinterpret_cast<int*>(base + c.offsetLargos);
+    int* idsOriginales = reinterpret_cast<int*>(base + c.offsetIdsOriginales);
+    for (int id = 0; id <= numDocs; ++id) {
+        largos[id] = id < static_cast<int>(indice.largoDocumentos.size()) ? indice.largoDocumentos[id] : 0;
+        idsOriginales[id] = id < static_cast<int>(indice.idsOriginales.size()) ? indice.idsOriginales[id] : id;
+    }
+    std::memcpy(base + c.offsetPageRank, tablaPageRank.datos,
+                std::min(bytesTablaPageRank(tablaPageRank), static_cast<size_t>(numDocs + 1) * c.bytesPageRank));
+
+    apuntarSecciones(segmento);
+}
+
+// el segmento ya esta en el formato del archivo, asi que se escribe de una
+bool escribirSegmento(const Segmento& segmento, const std::string& archivo) {
+    std::ofstream salida(archivo, std::ios::binary | std::ios::trunc);
+    if (!salida) return false;
+    salida.write(segmento.base, static_cast<std::streamsize>(segmento.tam));
+    return static_cast<bool>(salida);
+}
+
+// si [offset, offset + bytes) queda dentro de los primeros hasta bytes (sin desbordar la suma)
+bool dentroDe(unsigned long long offset, unsigned long long bytes, unsigned long long hasta) {
+    return offset <= hasta && bytes <= hasta - offset;
+}
+
+// revisa la cabecera: que sea nuestra, de esta version, entera y sin romper (la suma), y que las
+// secciones esten en orden, alineadas y sin pisarse. la tabla hash tiene que tener mas huecos que
+// terminos. no se mira nada de cada termino (seria recorrer todo el diccionario al abrir):
+// eso lo revisa buscarTerminoSegmento con la entrada que encuentra
+bool segmentoValido(const char* base, unsigned long long tam) {
+    const CabeceraSegmento* c = reinterpret_cast<const CabeceraSegmento*>(base);
+    if (std::memcmp(c->magia, MAGIA_SEGMENTO, sizeof(c->magia)) != 0 || c->version != VERSION_SEGMENTO ||
+        c->tamTotal != tam || c->sumaCabecera != sumaCabecera(*c))
+        return false;
+    unsigned int capacidad = c->capacidadTabla;
+    if (c->numDocs < 0 || c->numTerminos < 0 || capacidad == 0 || (capacidad & (capacidad - 1)) != 0 ||
+        capacidad <= static_cast<unsigned int>(c->numTerminos))
+        return false;
+    if (c->bytesPageRank != 2 && c->bytesPageRank != 4 && c->bytesPageRank != 8) return false;
+
+    const unsigned long long inicios[] = {c->offsetTabla, c->offsetTerminos, c->offsetTexto, c->offsetSaltos,
+                                          c->offsetDatos, c->offsetLargos, c->offsetPageRank,
+                                          c->offsetIdsOriginales, c->offsetMaximos, c->offsetMaximosPrior,
+                                          c->tamTotal};
+    const int numSecciones = sizeof(inicios) / sizeof(inicios[0]) - 1;
+    if (c->offsetTabla < sizeof(CabeceraSegmento) || c->offsetPageRank % 64 != 0) return false;
+    for (int i = 0; i < numSecciones; ++i)
+        if (inicios[i] % 8 != 0 || inicios[i] > inicios[i + 1]) return false;
+
+    // lo que tiene que entrar en cada seccion antes de que empiece la siguiente
+    unsigned long long docs = static_cast<unsigned long long>(c->numDocs) + 1;
+    unsigned long long numSaltos = (c->offsetDatos - c->offsetSaltos) / sizeof(SaltoBloque);
+    return dentroDe(c->offsetTabla, capacidad * static_cast<unsigned long long>(sizeof(unsigned int)), c->offsetTerminos) &&
+           dentroDe(c->offsetTerminos, c->numTerminos * static_cast<unsigned long long>(sizeof(EntradaTermino)), c->offsetTexto) &&
+           dentroDe(c->offsetLargos, docs * sizeof(int), c->offsetPageRank) &&
+           dentroDe(c->offsetPageRank, docs * c->bytesPageRank, c->offsetIdsOriginales) &&
+           dentroDe(c->offsetIdsOriginales, docs * sizeof(int), c->offsetMaximos) &&
+           dentroDe(c->offsetMaximos, numSaltos * sizeof(float), c->offsetMaximosPrior) &&
+           dentroDe(c->offsetMaximosPrior, numSaltos * sizeof(float), c->tamTotal);
+}
+
+// revisa que lo que dice la entrada de un termino quede dentro de sus secciones: la palabra, sus
+// saltos y el comienzo de sus bloques, y que cada salto apunte dentro de los datos con ids de 1 a
+// numDocs. se hace al buscar la palabra en un segmento mapeado, asi abrir no depende del tamaño del
+// indice y cada consulta solo mira los saltos de sus propias palabras (que igual va a leer).
+// los bloques no se descomprimen
+bool entradaValida(const Segmento& segmento, const EntradaTermino& e) {
+    const CabeceraSegmento* c = segmento.cabecera;
+    unsigned long long bytesTexto = c->offsetSaltos - c->offsetTexto;
+    unsigned long long numSaltos = (c->offsetDatos - c->offsetSaltos) / sizeof(SaltoBloque);
+    unsigned long long bytesDatos = c->offsetLargos - c->offsetDatos;
+    // todos los bloques llenos menos el ultimo, como los arma el indice
+    long long bloques = (static_cast<long long>(e.numDocs) + TAM_BLOQUE - 1) / TAM_BLOQUE;
+    if (e.numDocs < 0 || e.numBloques != bloques || !dentroDe(e.offsetTexto, e.largoTexto, bytesTexto) ||
+        !dentroDe(e.primerSalto, static_cast<unsigned long long>(e.numBloques), numSaltos) ||
+        e.offsetDatos > bytesDatos)
+        return false;
+    for (int b = 0; b < e.numBloques; ++b) {
+        const SaltoBloque& salto = segmento.saltos[e.primerSalto + b];
+        if (salto.offset > bytesDatos - e.offsetDatos || salto.primerId < 1 ||
+            salto.ultimoId < salto.primerId || salto.ultimoId > c->numDocs)
+            return false;
+    }
+    return true;
+}
+
+// mapeamos el archivo entero en memoria (solo lectura). el sistema va cargando las paginas
+// cuando se usan: al abrir solo se lee la cabecera, y el diccionario y las posting lists se
+// cargan recien cuando una consulta los pide
+bool abrirSegmento(const std::string& archivo, Segmento& segmento) {
+    int fd = open(archivo.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(CabeceraSegmento))) {
+        close(fd);
+        return false;
+    }
+    void* mapa = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd); // el mapa sigue valido aunque cerremos el descriptor
+    if (mapa == MAP_FAILED) return false;
+
+    // revisamos que sea un segmento nuestro, de esta version, entero y con las secciones adentro
+    if (!segmentoValido(static_cast<const char*>(mapa), static_cast<unsigned long long>(info.st_size))) {
+        munmap(mapa, info.st_size);
+        return false;
+    }
+
+    segmento.base = static_cast<const char*>(mapa);
+    segmento.tam = info.st_size;
+    segmento.mapeado = true;
+    segmento.memoria = nullptr;
+    apuntarSecciones(segmento);
+    return true;
+}
+
+// igual que buscarTermino pero en la tabla del segmento. lo que viene del archivo se revisa antes
+// de usarlo: el numero de termino de cada hueco, la entrada que coincide, y el sondeo da como mucho
+// una vuelta a la tabla (si un archivo roto no deja huecos libres no termina nunca)
+bool buscarTerminoSegmento(const Segmento& segmento, std::string_view termino, ListaPostings& lista) {
+    unsigned int hash = hashTermino(termino);
+    unsigned int mascara = segmento.cabecera->capacidadTabla - 1;
+    unsigned int numTerminos = static_cast<unsigned int>(segmento.cabecera->numTerminos);
+    unsigned int pos = hash & mascara;
+    for (unsigned int vuelta = 0; vuelta <= mascara && segmento.tabla[pos] != 0; ++vuelta) {
+        if (segmento.tabla[pos] > numTerminos) return false;
+        const EntradaTermino& e = segmento.terminos[segmento.tabla[pos] - 1];
+        if (e.hash == hash && e.largoTexto == termino.size() &&
+            dentroDe(e.offsetTexto, e.largoTexto, segmento.cabecera->offsetSaltos - segmento.cabecera->offsetTexto) &&
+            std::memcmp(segmento.texto + e.offsetTexto, termino.data(), termino.size()) == 0) {
+            // (uno armado en memoria lo armamos nosotros, no hace falta)
+            if (segmento.mapeado && !entradaValida(segmento, e)) return false;
+            // la vista apunta directo a los bytes del segmento, no se copia nada
+            lista.numDocs = e.numDocs;
+            lista.numBloques = e.numBloques;
+            lista.saltos = segmento.saltos + e.primerSalto;
+            lista.datos = segmento.datos + e.offsetDatos;
+            lista.termino = static_cast<int>(segmento.tabla[pos] - 1);
+            lista.maximos = segmento.maximos + e.primerSalto;
+            lista.maximosPrior = segmento.maximosPrior + e.primerSalto;
+            lista.maxPuntaje = e.maxPuntaje;
+            lista.maxPrior = e.maxPrior;
+            return true;
+        }
+        pos = (pos + 1) & mascara;
+    }
+    return false;
+}
+
+double pageRankSegmento(const Segmento& segmento, int idDoc) {
+    return pageRankTabla(segmento.pageRank, idDoc);
+}
+
+int idOriginal(const Segmento& segmento, int idDoc) {
+    if (idDoc < 0 || idDoc > segmento.cabecera->numDocs) return idDoc;
+    return segmento.idsOriginales[idDoc];
+}
+
+void cerrarSegmento(Segmento& segmento) {
+    if (segmento.mapeado) munmap(const_cast<char*>(segmento.base), segmento.tam);
+    std::free(segmento.memoria);
+    segmento.memoria = nullptr;
+    segmento.base = nullptr;
+    segmento.tam = 0;
+    segmento.mapeado = false;
+}
+
+FirmaArchivo firmaArchivo(const std::string& archivo) {
+    FirmaArchivo firma = {0, 0};
+    struct stat info;
+    if (stat(archivo.c_str(), &info) != 0) return firma;
+    firma.tam = static_cast<unsigned long long>(info.st_size);
+    firma.modificado = static_cast<long long>(info.st_mtim.tv_sec) * 1000000000LL + info.st_mtim.tv_nsec;
+    return firma;
+}
+
+bool mismoArchivo(const FirmaArchivo& a, const FirmaArchivo& b) {
+    return a.tam == b.tam && a.modificado == b.modificado;
+}
+
+bool mismasFirmas(const FirmasSegmento& a, const FirmasSegmento& b) {
+    return mismoArchivo(a.documentos, b.documentos) && mismoArchivo(a.consultas, b.consultas) &&
+           mismoArchivo(a.stopwords, b.stopwords);
+}
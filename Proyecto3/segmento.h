@@ -0,0 +1,118 @@
+#ifndef SEGMENTO_H
+#define SEGMENTO_H
+
+#include <string>
+#include <vector>
+#include "index.h"
+#include "grafo.h"
+
+// para que no se incluya dos veces
+// el segmento es el indice ya terminado guardado en un solo bloque de bytes, con el mismo
+// formato en memoria y en disco. asi se puede escribir una vez y despues abrirlo con mmap
+// sin leer ni armar nada: los punteros apuntan directo al archivo mapeado
+
+// para reconocer el archivo y su version
+const char MAGIA_SEGMENTO[8] = {'B', 'U', 'S', 'C', 'I', 'D', 'X', '1'};
+const unsigned int VERSION_SEGMENTO = 5;
+
+// tamaño y ultima modificacion de un archivo de entrada, para saber si el segmento esta al dia
+struct FirmaArchivo {
+    unsigned long long tam;
+    long long modificado;               // en nanosegundos (0 si no existe)
+};
+
+// los archivos con los que se armo el segmento
+struct FirmasSegmento {
+    FirmaArchivo documentos;
+    FirmaArchivo consultas;             // el log de consultas (de ahi sale el pagerank)
+    FirmaArchivo stopwords;
+};
+
+// lo primero del archivo, dice donde empieza cada seccion (todas alineadas a 8 bytes)
+struct CabeceraSegmento {
+    char magia[8];
+    unsigned int version;
+    int numDocs;                        // ids de 1 a numDocs
+    int numTerminos;
+    unsigned int capacidadTabla;        // huecos de la tabla hash de terminos (potencia de 2)
+    unsigned int ordenPageRank;         // 1 si los docs se renumeraron de mayor a menor pagerank
+    unsigned int bytesPageRank;         // cuanto ocupa el pagerank de cada doc (8, 4 o 2, ver TablaPageRank)
+    FirmasSegmento firmas;              // los archivos con los que se armo
+    unsigned long long offsetTabla;     // unsigned int por hueco: numero de termino + 1 (0 = vacio)
+    unsigned long long offsetTerminos;  // un EntradaTermino por termino
+    unsigned long long offsetTexto;     // las palabras una detras de otra
+    unsigned long long offsetSaltos;    // las tablas de saltos de todos los terminos
+    unsigned long long offsetDatos;     // los bloques comprimidos de todos los terminos
+    unsigned long long offsetLargos;    // tabla de documentos: cuantas palabras indexadas tiene cada doc
+    unsigned long long offsetPageRank;  // la TablaPageRank (alineada a 64 bytes, una linea de cache)
+    unsigned long long offsetIdsOriginales; // el id de linea de cada doc (el mismo si no se renumero)
+    unsigned long long offsetMaximos;   // el BM25 maximo de cada bloque (un float por salto, en el mismo orden)
+    unsigned long long offsetMaximosPrior; // el mayor aporte del pagerank en cada bloque (un float por salto)
+    double largoPromedio;               // el largo promedio de los docs, para BM25
+    double escalaPageRank;              // la escala de la tabla si es de 16 bits
+    unsigned long long tamTotal;
+    unsigned long long sumaCabecera;    // FNV-1a de la cabecera con este campo en 0, para ver que no se rompio
+};
+
+// lo que se guarda de cada termino en el diccionario
+struct EntradaTermino {
+    unsigned int hash;                  // hashTermino de la palabra
+    unsigned int largoTexto;            // cuantas letras tiene
+    unsigned long long offsetTexto;     // donde empieza la palabra en la seccion de texto
+    unsigned long long primerSalto;     // donde empieza su tabla de saltos (en entradas)
+    unsigned long long offsetDatos;     // donde empiezan sus bloques (en bytes)
+    int numDocs;
+    int numBloques;
+    float maxPuntaje;                   // el BM25 maximo de todos sus docs
+    float maxPrior;                     // el mayor aporte del pagerank de sus docs
+};
+
+// el segmento abierto: solo punteros a las secciones
+struct Segmento {
+    const char* base;                   // donde empieza todo
+    size_t tam;                         // cuantos bytes
+    bool mapeado;                       // true si viene de mmap, false si esta en memoria
+    char* memoria;                      // los bytes cuando se armo en memoria (alineados a 64 bytes, como el mmap)
+    const CabeceraSegmento* cabecera;
+    const unsigned int* tabla;
+    const EntradaTermino* terminos;
+    const char* texto;
+    const SaltoBloque* saltos;
+    const unsigned char* datos;
+    const int* largos;                  // numDocs + 1 (la posicion 0 no se usa)
+    TablaPageRank pageRank;             // vista de la tabla del archivo
+    const int* idsOriginales;           // numDocs + 1
+    const float* maximos;               // uno por salto
+    const float* maximosPrior;          // uno por salto
+};
+
+// arma el segmento en memoria a partir del indice y de la tabla de pagerank (con los mismos ids)
+void construirSegmento(const IndiceInvertido& indice, const TablaPageRank& tablaPageRank,
+                       const FirmasSegmento& firmas, Segmento& segmento);
+
+// escribe el segmento a un archivo. devuelve false si no se pudo
+bool escribirSegmento(const Segmento& segmento, const std::string& archivo);
+
+// abre un segmento de disco con mmap. devuelve false si no existe o no es valido
+bool abrirSegmento(const std::string& archivo, Segmento& segmento);
+
+// busca la posting list de una palabra en el diccionario del segmento.
+// si la entrada de la palabra apunta fuera de sus secciones (archivo roto) es como si no estuviera
+bool buscarTerminoSegmento(const Segmento& segmento, std::string_view termino, ListaPostings& lista);
+
+// el pagerank de un documento (0 si no esta)
+double pageRankSegmento(const Segmento& segmento, int idDoc);
+
+// el id con el que se muestra un documento: su linea en el archivo, aunque se haya renumerado
+int idOriginal(const Segmento& segmento, int idDoc);
+
+// para desmapear o liberar el segmento
+void cerrarSegmento(Segmento& segmento);
+
+// la firma de un archivo (todo en 0 si no existe)
+FirmaArchivo firmaArchivo(const std::string& archivo);
+
+// si los archivos son los mismos (mismo tamaño y misma fecha de modificacion)
+bool mismasFirmas(const FirmasSegmento& a, const FirmasSegmento& b);
+
+#endif // SEGMENTO_H
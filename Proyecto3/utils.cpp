@@ -1,5 +1,6 @@
 #include "utils.h"
 #include <fstream>
+#include <sstream>
 #include <cctype>
 #include <algorithm>
 
@@ -12,6 +13,58 @@ std::string aMinuscula(const std::string& palabra) {
     return resultado;
 }
 
+// funcion clave para la cache
+// la idea es que "big house" y "house big" den la misma clave para que funcione el cache
+std::string normalizarConsulta(std::string s) {
+    // poner en minusculas
+    std::transform(s.begin(), s.end(), s.begin(),
+                   [](unsigned char c){ return std::tolower(c); });
+
+    // separar las palabras en un vector
+    std::istringstream iss(s);
+    std::string palabra;
+    std::vector<std::string> palabras;
+    while (iss >> palabra) {
+        palabras.push_back(palabra);
+    }
+
+    //ordenar las palabras alfabeticamente
+    std::sort(palabras.begin(), palabras.end());
+
+    // unir las palabras para crear la clave final
+    std::string clave_normalizada;
+    for (size_t i = 0; i < palabras.size(); ++i) {
+        clave_normalizada += palabras[i] + (i == palabras.size() - 1 ? "" : " ");
+    }
+    
+    return clave_normalizada;
+}
+
+// tabla para clasificar cada byte de una vez, en vez de llamar a isalpha y tolower:
+// 0 = se ignora (numeros, puntuacion), 1 = separa palabras (espacios), si no la letra en minuscula
+const unsigned char IGNORAR = 0;
+const unsigned char SEPARADOR = 1;
+
+struct TablaCaracteres {
+    unsigned char valor[256];
+};
+
+constexpr TablaCaracteres crearTablaCaracteres() {
+    TablaCaracteres tabla = {};
+    // los mismos espacios que usa el >> de los streams
+    tabla.valor[static_cast<unsigned char>(' ')] = SEPARADOR;
+    tabla.valor[static_cast<unsigned char>('\t')] = SEPARADOR;
+    tabla.valor[static_cast<unsigned char>('\n')] = SEPARADOR;
+    tabla.valor[static_cast<unsigned char>('\v')] = SEPARADOR;
+    tabla.valor[static_cast<unsigned char>('\f')] = SEPARADOR;
+    tabla.valor[static_cast<unsigned char>('\r')] = SEPARADOR;
+    for (int c = 'a'; c <= 'z'; ++c) tabla.valor[c] = static_cast<unsigned char>(c);
+    for (int c = 'A'; c <= 'Z'; ++c) tabla.valor[c] = static_cast<unsigned char>(c - 'A' + 'a');
+    return tabla;
+}
+
+constexpr TablaCaracteres TABLA_CARACTERES = crearTablaCaracteres();
+
 // funcion para limpiar las palabras
 // le quita los signos de puntuacion y numeros, y la pasa a minuscula
 std::string limpiarPalabra(const std::string& palabra) {
@@ -19,27 +72,141 @@ std::string limpiarPalabra(const std::string& palabra) {
     // recorremos la palabra caracter por caracter
     for (char c : palabra) {
         // si es una letra, la agregamos al resultado (ya en minuscula)
-        if (std::isalpha(static_cast<unsigned char>(c))) {
-            resultado += std::tolower(c);
-        }
+        unsigned char letra = TABLA_CARACTERES.valor[static_cast<unsigned char>(c)];
+        if (letra > SEPARADOR) resultado += static_cast<char>(letra);
     }
     return resultado;
 }
 
-// funcion para leer el archivo de stopwords y meterlas en un set
-void cargarStopwords(const std::string& nombreArchivo, std::set<std::string>& stopwords) {
+void iniciarTokenizador(Tokenizador& tokenizador, std::string_view texto) {
+    tokenizador.actual = texto.data();
+    tokenizador.fin = texto.data() + texto.size();
+}
+
+// buscamos la siguiente palabra (lo que hay entre espacios) y nos quedamos con sus letras
+bool siguientePalabra(Tokenizador& tokenizador, std::string_view& palabra) {
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(tokenizador.actual);
+    const unsigned char* fin = reinterpret_cast<const unsigned char*>(tokenizador.fin);
+    while (true) {
+        // saltamos los espacios
+        while (p < fin && TABLA_CARACTERES.valor[*p] == SEPARADOR) ++p;
+        if (p == fin) {
+            tokenizador.actual = tokenizador.fin;
+            return false;
+        }
+
+        // recorremos la palabra y vemos si ya esta limpia (solo minusculas)
+        const unsigned char* inicio = p;
+        bool limpia = true;
+        while (p < fin && TABLA_CARACTERES.valor[*p] != SEPARADOR) {
+            if (*p < 'a' || *p > 'z') limpia = false;
+            ++p;
+        }
+        tokenizador.actual = reinterpret_cast<const char*>(p);
+
+        // si esta limpia la devolvemos tal cual, sin copiarla
+        if (limpia) {
+            palabra = std::string_view(reinterpret_cast<const char*>(inicio), p - inicio);
+            return true;
+        }
+
+        // si no, la limpiamos en el buffer (que ya tiene memoria de las anteriores)
+        tokenizador.auxiliar.clear();
+        for (const unsigned char* q = inicio; q < p; ++q) {
+            unsigned char letra = TABLA_CARACTERES.valor[*q];
+            if (letra > SEPARADOR) tokenizador.auxiliar.push_back(static_cast<char>(letra));
+        }
+        // si no quedo ninguna letra (por ejemplo "123") seguimos con la siguiente
+        if (!tokenizador.auxiliar.empty()) {
+            palabra = tokenizador.auxiliar;
+            return true;
+        }
+    }
+}
+
+// FNV-1a con semilla, la semilla cambia el valor inicial y asi cambia donde cae cada palabra
+unsigned int hashStopword(std::string_view palabra, unsigned int semilla) {
+    unsigned int hash = 2166136261u ^ (semilla * 0x9E3779B9u);
+    for (char c : palabra) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 16777619u;
+    }
+    // mezclamos un poco al final para que los bits bajos (los que usa la tabla) dependan de todo
+    hash ^= hash >> 15;
+    return hash;
+}
+
+// prueba si con esta semilla todas las stopwords caen en huecos distintos
+bool probarSemilla(FiltroStopwords& stopwords, unsigned int semilla) {
+    std::fill(stopwords.tabla.begin(), stopwords.tabla.end(), 0);
+    for (size_t i = 0; i < stopwords.entradas.size(); ++i) {
+        EntradaStopword& e = stopwords.entradas[i];
+        e.hash = hashStopword(std::string_view(stopwords.texto).substr(e.offset, e.largo), semilla);
+        unsigned int& hueco = stopwords.tabla[e.hash & stopwords.mascara];
+        if (hueco != 0) return false;
+        hueco = static_cast<unsigned int>(i) + 1;
+    }
+    stopwords.semilla = semilla;
+    return true;
+}
+
+void cargarStopwords(const std::string& nombreArchivo, FiltroStopwords& stopwords) {
     //abrimos el archivo
     std::ifstream archivo(nombreArchivo);
     std::string palabra;
+    std::vector<std::string> palabras;
     // leemos palabra por palabra hasta que se acabe el archivo
     while (archivo >> palabra) {
-        // y la metemos al set (en minuscula para que siempre coincida)
-        stopwords.insert(aMinuscula(palabra));
+        // en minuscula para que siempre coincida
+        palabras.push_back(aMinuscula(palabra));
+    }
+    // sacamos las repetidas (antes el set las juntaba solo)
+    std::sort(palabras.begin(), palabras.end());
+    palabras.erase(std::unique(palabras.begin(), palabras.end()), palabras.end());
+
+    // las guardamos todas juntas en el texto y marcamos sus largos y primeras letras
+    stopwords.largos = 0;
+    for (int k = 0; k < 4; ++k) stopwords.primeras[k] = 0;
+    stopwords.entradas.clear();
+    stopwords.texto.clear();
+    for (const std::string& p : palabras) {
+        EntradaStopword e;
+        e.hash = 0;
+        e.offset = static_cast<unsigned int>(stopwords.texto.size());
+        e.largo = static_cast<unsigned int>(p.size());
+        stopwords.entradas.push_back(e);
+        stopwords.texto += p;
+        stopwords.largos |= 1ULL << std::min<size_t>(p.size(), 63);
+        unsigned char primera = static_cast<unsigned char>(p[0]);
+        stopwords.primeras[primera >> 6] |= 1ULL << (primera & 63);
+    }
+
+    // buscamos una semilla sin choques. empezamos con 8 huecos por palabra (asi los choques son
+    // pocos y una semilla buena sale rapido) y si en varias pruebas no sale agrandamos la tabla
+    unsigned int capacidad = 1;
+    while (capacidad < 8 * stopwords.entradas.size()) capacidad *= 2;
+    while (true) {
+        stopwords.tabla.assign(capacidad, 0);
+        stopwords.mascara = capacidad - 1;
+        for (unsigned int semilla = 0; semilla < 256; ++semilla)
+            if (probarSemilla(stopwords, semilla)) return;
+        capacidad *= 2;
     }
 }
 
 // para chequear si una palabra es stopword o no
-bool esStopword(const std::string& palabra, const std::set<std::string>& stopwords) {
-    // usamos find() del set. si no lo encuentra devuelve stopwords.end()
-    return stopwords.find(palabra) != stopwords.end();
+bool esStopword(std::string_view palabra, const FiltroStopwords& stopwords) {
+    // casi todas las palabras se descartan aca, sin calcular el hash
+    if (palabra.empty()) return false;
+    if (!(stopwords.largos & (1ULL << std::min<size_t>(palabra.size(), 63)))) return false;
+    unsigned char primera = static_cast<unsigned char>(palabra[0]);
+    if (!(stopwords.primeras[primera >> 6] & (1ULL << (primera & 63)))) return false;
+
+    // la unica stopword que puede ser es la de su hueco
+    unsigned int hash = hashStopword(palabra, stopwords.semilla);
+    unsigned int hueco = stopwords.tabla[hash & stopwords.mascara];
+    if (hueco == 0) return false;
+    const EntradaStopword& e = stopwords.entradas[hueco - 1];
+    return e.hash == hash && e.largo == palabra.size() &&
+           std::string_view(stopwords.texto).substr(e.offset, e.largo) == palabra;
 }
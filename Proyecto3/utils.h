@@ -2,20 +2,63 @@
 #define UTILS_H
 
 #include <string>
-#include <set>
+#include <string_view>
+#include <vector>
 
 // include guard para que no se incluya mil veces
 
 // para pasar a minuscula
 std::string aMinuscula(const std::string& palabra);
 
+// para usar la consulta como clave de la cache: minusculas y palabras ordenadas
+// ("big house" y "house big" dan la misma clave)
+std::string normalizarConsulta(std::string s);
+
 // para quitarle la basura a las palabras (puntos, comas, etc)
 std::string limpiarPalabra(const std::string& palabra);
 
-// para leer el archivo de stopwords
-void cargarStopwords(const std::string& nombreArchivo, std::set<std::string>& stopwords);
+// una stopword guardada en el filtro
+struct EntradaStopword {
+    unsigned int hash;      // el hash completo, para descartar rapido antes de comparar letras
+    unsigned int offset;    // donde empieza la palabra en el texto
+    unsigned int largo;     // cuantas letras tiene
+};
+
+// las stopwords no cambian despues de cargarlas, asi que en vez de un set armamos un filtro fijo:
+// primero se mira si hay alguna stopword de ese largo y con esa primera letra (dos mascaras de bits),
+// y si pasa, una tabla hash perfecta (se elige una semilla con la que ninguna stopword choca)
+// dice en un solo acceso cual es la unica stopword que podria ser
+struct FiltroStopwords {
+    unsigned long long largos;          // bit i = hay stopwords de largo i (el 63 es para 63 o mas)
+    unsigned long long primeras[4];     // bit c = hay stopwords que empiezan con el byte c
+    unsigned int semilla;               // la semilla del hash que no tiene choques
+    unsigned int mascara;               // huecos de la tabla - 1 (potencia de 2)
+    std::vector<unsigned int> tabla;    // por hueco: numero de stopword + 1 (0 = vacio)
+    std::vector<EntradaStopword> entradas;
+    std::string texto;                  // todas las stopwords una detras de otra
+};
+
+// para leer el archivo de stopwords y armar el filtro
+void cargarStopwords(const std::string& nombreArchivo, FiltroStopwords& stopwords);
 
 // para ver si una palabra es stopword
-bool esStopword(const std::string& palabra, const std::set<std::string>& stopwords);
+bool esStopword(std::string_view palabra, const FiltroStopwords& stopwords);
+
+// tokenizador sin copias: recorre un texto y va devolviendo las palabras ya limpias
+// (igual que separar por espacios y pasar cada una por limpiarPalabra).
+// si la palabra ya esta limpia (solo minusculas) se devuelve un pedazo del mismo texto,
+// si no se limpia en un buffer que se reusa, asi no se pide memoria por cada palabra
+struct Tokenizador {
+    const char* actual;     // por donde vamos leyendo
+    const char* fin;        // donde termina el texto
+    std::string auxiliar;   // buffer para las palabras que hay que limpiar
+};
+
+// para empezar a recorrer un texto (el texto tiene que seguir vivo mientras se usa)
+void iniciarTokenizador(Tokenizador& tokenizador, std::string_view texto);
+
+// deja en palabra la siguiente palabra limpia, devuelve false cuando se acaba el texto
+// ojo: la palabra deja de valer cuando se pide la siguiente
+bool siguientePalabra(Tokenizador& tokenizador, std::string_view& palabra);
 
 #endif // UTILS_H